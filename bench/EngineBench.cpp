@@ -0,0 +1,68 @@
+// Compares the pitch-shifting engines per 256-frame / 44.1 kHz block: mean
+// and worst-case processing time, the resulting share of the realtime
+// budget, and the latency each engine adds at that ratio.
+#include "PitchEngine.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    const size_t blockSize = 256;
+    const float sampleRate = 44100.0f;
+    const size_t blocksPerRun = 2000;
+    size_t numChannels = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1;
+    if (numChannels == 0) numChannels = 1;
+    
+    const EngineType engines[] = {EngineType::Granular, EngineType::PhaseVocoder};
+    const char* engineNames[] = {"granular", "vocoder"};
+    const float semitones[] = {-12.0f, -5.0f, 7.0f, 12.0f};
+    
+    double deadline = blockSize / sampleRate;
+    std::cout << "Engines: " << blockSize << " frames x " << numChannels << " channels at " << sampleRate
+              << " Hz, deadline " << (deadline * 1e3) << " ms, " << blocksPerRun << " blocks per run\n";
+    std::cout << std::setw(10) << "engine" << std::setw(10) << "semitones" << std::setw(12) << "mean (us)"
+              << std::setw(12) << "max (us)" << std::setw(10) << "load" << std::setw(16) << "latency (smp)"
+              << std::setw(14) << "latency (ms)" << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    
+    std::vector<float> block(blockSize * numChannels);
+    
+    using Clock = std::chrono::steady_clock;
+    for (size_t e = 0; e < 2; ++e) {
+        for (float shift : semitones) {
+            ArenaPtr<PitchEngine> engine = createPitchEngine(engines[e], blockSize, sampleRate,
+                                                             numChannels, 1024.0f * 1000.0f / 44100.0f);
+            engine->setPitchRatio(std::pow(2.0f, shift / 12.0f));
+            
+            double total = 0.0;
+            double worst = 0.0;
+            size_t phase = 0;
+            for (size_t b = 0; b < blocksPerRun; ++b) {
+                for (size_t i = 0; i < blockSize; ++i, ++phase) {
+                    float sample = 0.5f * std::sin(0.0627f * phase) + 0.25f * std::sin(0.1881f * phase);
+                    for (size_t ch = 0; ch < numChannels; ++ch) {
+                        block[i * numChannels + ch] = sample;
+                    }
+                }
+                
+                auto start = Clock::now();
+                engine->processInterleaved(block.data(), block.data(), blockSize);
+                double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                total += seconds;
+                worst = std::max(worst, seconds);
+            }
+            
+            double mean = total / blocksPerRun;
+            size_t latency = engine->getLatencySamples();
+            std::cout << std::setw(10) << engineNames[e] << std::setw(10) << std::showpos << shift << std::noshowpos
+                      << std::setw(12) << (mean * 1e6) << std::setw(12) << (worst * 1e6)
+                      << std::setw(9) << (100.0 * mean / deadline) << "%" << std::setw(16) << latency
+                      << std::setw(14) << (1e3 * latency / sampleRate) << "\n";
+        }
+    }
+    
+    return 0;
+}
\ No newline at end of file
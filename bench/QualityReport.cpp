@@ -0,0 +1,421 @@
+// Deterministic quality and regression report for the DSP. Synthetic sines,
+// sweeps, impulses, noise and vowels are run through each engine and SpectralMeter's
+// FFT; every measurement is printed next to its limit, and the exit status is
+// non-zero if any limit is exceeded, so refactors can be checked in one run.
+#include "PitchEngine.h"
+#include "PitchDetector.h"
+#include "PitchProcessor.h"
+#include "FFT.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float kSampleRate = 44100.0f;
+const size_t kBlockSize = 256;
+const size_t kAnalysisSize = 16384;
+const double kTwoPi = 6.283185307179586;
+// Untracked 1024-sample grains cross-fade every 512 samples, which splits a
+// pure tone into lines this far apart around the shifted pitch
+const double kGrainRateHz = kSampleRate / 512.0;
+
+struct EngineConfig {
+    const char* name;
+    EngineType type;
+    bool trackPitch;
+};
+
+const EngineConfig kEngines[] = {
+    {"granular", EngineType::Granular, false},
+    {"granular+track", EngineType::Granular, true},
+    {"vocoder", EngineType::PhaseVocoder, false},
+};
+
+int failures = 0;
+
+void report(const std::string& check, const std::string& config, double value, const char* unit,
+            double limit, bool pass) {
+    std::cout << std::left << std::setw(28) << check << std::setw(24) << config << std::right
+              << std::setw(12) << value << " " << std::left << std::setw(7) << unit << std::right
+              << std::setw(10) << limit << "  " << (pass ? "ok" : "FAIL") << "\n";
+    if (!pass) ++failures;
+}
+
+std::vector<float> sine(float frequency, size_t length) {
+    std::vector<float> signal(length);
+    for (size_t i = 0; i < length; ++i) {
+        signal[i] = 0.5f * static_cast<float>(std::sin(kTwoPi * frequency * i / kSampleRate));
+    }
+    return signal;
+}
+
+std::vector<float> sweep(float startHz, float endHz, size_t length) {
+    std::vector<float> signal(length);
+    double phase = 0.0;
+    for (size_t i = 0; i < length; ++i) {
+        double frequency = startHz * std::pow(endHz / startHz, static_cast<double>(i) / length);
+        phase += kTwoPi * frequency / kSampleRate;
+        signal[i] = 0.5f * static_cast<float>(std::sin(phase));
+    }
+    return signal;
+}
+
+std::vector<float> noise(size_t length) {
+    std::vector<float> signal(length);
+    uint32_t state = 12345;
+    for (size_t i = 0; i < length; ++i) {
+        state = state * 1664525u + 1013904223u;
+        signal[i] = static_cast<float>(state >> 8) / 16777216.0f - 0.5f;
+    }
+    return signal;
+}
+
+// Sawtooth voice at 130 Hz with vibrato through /a/ formant resonators
+std::vector<float> vowel(size_t length) {
+    const double formants[3] = {700.0, 1220.0, 2600.0};
+    const double bandwidths[3] = {110.0, 120.0, 160.0};
+    double state[3][2] = {};
+    std::vector<float> signal(length);
+    double phase = 0.0;
+    for (size_t i = 0; i < length; ++i) {
+        phase += 130.0 * (1.0 + 0.02 * std::sin(kTwoPi * 5.0 * i / kSampleRate)) / kSampleRate;
+        phase -= std::floor(phase);
+        double x = 2.0 * phase - 1.0;
+        for (size_t k = 0; k < 3; ++k) {
+            double r = std::exp(-kTwoPi * 0.5 * bandwidths[k] / kSampleRate);
+            double y = (1.0 - r) * x + 2.0 * r * std::cos(kTwoPi * formants[k] / kSampleRate) * state[k][0] -
+                       r * r * state[k][1];
+            state[k][1] = state[k][0];
+            state[k][0] = y;
+            x = y;
+        }
+        signal[i] = static_cast<float>(x);
+    }
+    return signal;
+}
+
+double energy(const float* samples, size_t length) {
+    double sum = 0.0;
+    for (size_t i = 0; i < length; ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return sum;
+}
+
+double toDb(double ratio) {
+    return 10.0 * std::log10(std::max(ratio, 1e-30));
+}
+
+// Runs input through a fresh engine in blocks of blockSize, optionally
+// feeding the pitch tracker's period to the engine before each block
+std::vector<float> process(const EngineConfig& config, float semitones, const std::vector<float>& input,
+                           size_t blockSize = kBlockSize, size_t engineBlockSize = kBlockSize) {
+    ArenaPtr<PitchEngine> engine = createPitchEngine(config.type, engineBlockSize, kSampleRate, 1,
+                                                     1024.0f * 1000.0f / 44100.0f);
+    engine->setPitchRatio(std::pow(2.0f, semitones / 12.0f));
+    PitchDetector detector(kSampleRate);
+    
+    std::vector<float> output(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += blockSize) {
+        size_t count = std::min(blockSize, input.size() - offset);
+        if (config.trackPitch) {
+            detector.pushSamples(&input[offset], count);
+            engine->setPitchPeriod(detector.getPeriod());
+        }
+        engine->processBlock(&input[offset], &output[offset], count);
+    }
+    return output;
+}
+
+// Runs input through a PitchProcessor, as hosts do, in blocks of blockSize
+std::vector<float> processChain(const EngineConfig& config, float semitones, bool preserveFormants,
+                                const std::vector<float>& input, size_t blockSize = kBlockSize) {
+    PitchProcessorConfig chain;
+    chain.engine = config.type;
+    chain.sampleRate = kSampleRate;
+    chain.hopSize = kBlockSize;
+    chain.semitones = semitones;
+    chain.trackPitch = config.trackPitch;
+    chain.preserveFormants = preserveFormants;
+    PitchProcessor processor(chain);
+    
+    std::vector<float> output(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += blockSize) {
+        size_t count = std::min(blockSize, input.size() - offset);
+        processor.processInterleaved(&input[offset], &output[offset], count);
+    }
+    return output;
+}
+
+// Power spectrum of the last kAnalysisSize samples, Hann windowed
+std::vector<double> powerSpectrum(const std::vector<float>& signal) {
+    RealFFTPlan plan(kAnalysisSize);
+    std::vector<float> frame(kAnalysisSize);
+    const float* tail = signal.data() + signal.size() - kAnalysisSize;
+    for (size_t i = 0; i < kAnalysisSize; ++i) {
+        frame[i] = tail[i] * static_cast<float>(0.5 - 0.5 * std::cos(kTwoPi * i / kAnalysisSize));
+    }
+    std::vector<std::complex<float>> spectrum(plan.getNumBins());
+    plan.forward(frame.data(), spectrum.data());
+    
+    std::vector<double> power(spectrum.size());
+    for (size_t k = 0; k < spectrum.size(); ++k) {
+        power[k] = std::norm(spectrum[k]);
+    }
+    return power;
+}
+
+// Strongest frequency, refined by parabolic interpolation of log power
+double peakFrequency(const std::vector<double>& power) {
+    size_t peak = std::max_element(power.begin() + 1, power.end() - 1) - power.begin();
+    double a = std::log(power[peak - 1] + 1e-30);
+    double b = std::log(power[peak] + 1e-30);
+    double c = std::log(power[peak + 1] + 1e-30);
+    double offset = 0.5 * (a - c) / (a - 2.0 * b + c);
+    return (peak + offset) * kSampleRate / kAnalysisSize;
+}
+
+// Share of power outside [lowHz, highHz]
+double leakage(const std::vector<double>& power, double lowHz, double highHz) {
+    double binHz = kSampleRate / kAnalysisSize;
+    double low = lowHz / binHz;
+    double high = highHz / binHz;
+    double inside = 0.0;
+    double total = 0.0;
+    for (size_t k = 1; k < power.size(); ++k) {
+        total += power[k];
+        if (k >= low && k <= high) inside += power[k];
+    }
+    return (total - inside) / std::max(total, 1e-30);
+}
+
+// Spectral envelope as third-octave band levels from 200 Hz to 4 kHz, in dB
+// relative to their sum, averaged over the whole signal after a settling time
+std::vector<double> bandLevels(const std::vector<float>& signal) {
+    const size_t frameSize = 2048;
+    RealFFTPlan plan(frameSize);
+    std::vector<float> frame(frameSize);
+    std::vector<std::complex<float>> spectrum(plan.getNumBins());
+    std::vector<double> power(spectrum.size(), 0.0);
+    for (size_t start = 44100 / 2; start + frameSize <= signal.size(); start += frameSize / 2) {
+        for (size_t i = 0; i < frameSize; ++i) {
+            frame[i] = signal[start + i] * static_cast<float>(0.5 - 0.5 * std::cos(kTwoPi * i / frameSize));
+        }
+        plan.forward(frame.data(), spectrum.data());
+        for (size_t k = 0; k < spectrum.size(); ++k) {
+            power[k] += std::norm(spectrum[k]);
+        }
+    }
+    
+    std::vector<double> bands;
+    double total = 0.0;
+    for (double low = 200.0; low < 4000.0; low *= std::cbrt(2.0)) {
+        double band = 0.0;
+        for (size_t k = 0; k < power.size(); ++k) {
+            double frequency = k * kSampleRate / frameSize;
+            if (frequency >= low && frequency < low * std::cbrt(2.0)) band += power[k];
+        }
+        bands.push_back(band);
+        total += band;
+    }
+    for (double& band : bands) {
+        band = toDb(band / total);
+    }
+    return bands;
+}
+
+// RMS difference between two band-level envelopes, in dB
+double envelopeError(const std::vector<double>& reference, const std::vector<double>& levels) {
+    double sum = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        sum += (levels[i] - reference[i]) * (levels[i] - reference[i]);
+    }
+    return std::sqrt(sum / reference.size());
+}
+
+void checkFFT() {
+    // RealFFTPlan against a direct DFT and through a round trip. The real
+    // transform runs a half-size complex FFT, so 16 and 1024 points take the
+    // leading radix-2 stage and 32 and 2048 (the vocoder's frame) are pure
+    // radix-4.
+    const size_t sizes[] = {16, 32, 1024, 2048};
+    for (size_t size : sizes) {
+        std::string label = std::to_string(size) + "-point";
+        RealFFTPlan plan(size);
+        std::vector<float> input = noise(size);
+        std::vector<std::complex<float>> spectrum(plan.getNumBins());
+        plan.forward(input.data(), spectrum.data());
+        
+        double maxError = 0.0;
+        double maxMagnitude = 0.0;
+        for (size_t k = 0; k < plan.getNumBins(); ++k) {
+            std::complex<double> sum = 0.0;
+            for (size_t n = 0; n < size; ++n) {
+                sum += static_cast<double>(input[n]) * std::polar(1.0, -kTwoPi * k * n / size);
+            }
+            maxError = std::max(maxError, std::abs(sum - std::complex<double>(spectrum[k])));
+            maxMagnitude = std::max(maxMagnitude, std::abs(sum));
+        }
+        double error = toDb(maxError * maxError / (maxMagnitude * maxMagnitude));
+        report("fft vs dft error", label, error, "dB", -100.0, error < -100.0);
+        
+        std::vector<float> roundTrip(size);
+        plan.inverse(spectrum.data(), roundTrip.data());
+        double residual = 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            residual += (roundTrip[i] - input[i]) * (roundTrip[i] - input[i]);
+        }
+        double roundTripDb = toDb(residual / energy(input.data(), size));
+        report("fft round trip error", label, roundTripDb, "dB", -120.0, roundTripDb < -120.0);
+    }
+    
+    // Hann leakage of an off-bin sine, as the spectral meter sees it
+    std::vector<float> tone = sine(1000.5f * kSampleRate / kAnalysisSize, kAnalysisSize);
+    std::vector<double> power = powerSpectrum(tone);
+    double toneHz = 1000.5 * kSampleRate / kAnalysisSize;
+    double leak = toDb(leakage(power, toneHz / std::pow(2.0, 1.0 / 12.0), toneHz * std::pow(2.0, 1.0 / 12.0)));
+    report("fft hann leakage", "off-bin sine", leak, "dB", -80.0, leak < -80.0);
+}
+
+void checkPitch(const EngineConfig& config) {
+    const float semitones[] = {-12.0f, -5.0f, 7.0f, 12.0f};
+    const float inputHz = 440.0f;
+    std::vector<float> input = sine(inputHz, 3 * 44100);
+    
+    for (float shift : semitones) {
+        std::vector<float> output = process(config, shift, input);
+        std::vector<double> power = powerSpectrum(output);
+        double target = inputHz * std::pow(2.0, shift / 12.0);
+        double peak = peakFrequency(power);
+        
+        std::string label = std::string(config.name) + (shift > 0 ? " +" : " ") + std::to_string(static_cast<int>(shift));
+        if (config.type == EngineType::Granular && !config.trackPitch) {
+            // Untracked grains restart in the input's phase, so the tone
+            // becomes lines kGrainRateHz apart spread around the target; the
+            // strongest line must be one of its neighbors and the lines beyond
+            // them must stay weak
+            double offset = peak - target;
+            double leak = toDb(leakage(power, target - kGrainRateHz, target + kGrainRateHz));
+            report("partial offset from target", label, offset, "Hz", kGrainRateHz, std::fabs(offset) <= kGrainRateHz);
+            report("leakage outside grain rate", label, leak, "dB", -25.0, leak <= -25.0);
+        } else {
+            double cents = 1200.0 * std::log2(peak / target);
+            double leak = toDb(leakage(power, target / std::pow(2.0, 1.0 / 12.0), target * std::pow(2.0, 1.0 / 12.0)));
+            report("pitch error", label, cents, "cents", 5.0, std::fabs(cents) <= 5.0);
+            report("leakage outside +-1 st", label, leak, "dB", -20.0, leak <= -20.0);
+        }
+    }
+}
+
+void checkAliasing(const EngineConfig& config) {
+    // Every component lands above Nyquist at +12, so ideal output is silent
+    std::vector<float> input = sweep(11500.0f, 20000.0f, 3 * 44100);
+    std::vector<float> output = process(config, 12.0f, input);
+    size_t settle = 44100 / 2;
+    double level = toDb(energy(output.data() + settle, output.size() - settle) /
+                        energy(input.data() + settle, input.size() - settle));
+    report("aliasing, sweep 11.5-20k", std::string(config.name) + " +12", level, "dB", -20.0, level < -20.0);
+}
+
+// Index of the loudest output sample for a unit impulse at sample 0
+size_t impulsePeak(const EngineConfig& config, float mix, bool compensateDry, size_t& latency) {
+    ArenaPtr<PitchEngine> engine = createPitchEngine(config.type, kBlockSize, kSampleRate, 1,
+                                                     1024.0f * 1000.0f / 44100.0f);
+    engine->setMixLevel(mix);
+    engine->setDryCompensation(compensateDry);
+    std::vector<float> input(8192, 0.0f);
+    input[0] = 1.0f;
+    std::vector<float> output(input.size());
+    for (size_t offset = 0; offset < input.size(); offset += kBlockSize) {
+        engine->processBlock(&input[offset], &output[offset], kBlockSize);
+    }
+    
+    size_t peak = 0;
+    for (size_t i = 1; i < output.size(); ++i) {
+        if (std::fabs(output[i]) > std::fabs(output[peak])) peak = i;
+    }
+    latency = engine->getLatencySamples();
+    return peak;
+}
+
+void checkLatency(const EngineConfig& config) {
+    size_t latency;
+    size_t peak = impulsePeak(config, 1.0f, false, latency);
+    double error = static_cast<double>(peak) - static_cast<double>(latency);
+    report("impulse peak vs latency", std::string(config.name) + " unison", error, "samples", 1.0,
+           std::fabs(error) <= 1.0);
+    
+    // With the dry path compensated, a 50% mix must still peak at the
+    // latency rather than at the undelayed dry impulse
+    peak = impulsePeak(config, 0.5f, true, latency);
+    error = static_cast<double>(peak) - static_cast<double>(latency);
+    report("aligned dry peak vs latency", std::string(config.name) + " mix 0.5", error, "samples", 1.0,
+           std::fabs(error) <= 1.0);
+}
+
+void checkBlockSizes(const EngineConfig& config) {
+    // Host blocks from a single frame to many hops, against the hop itself;
+    // tracking updates land on hops too, so it is covered as well
+    std::vector<float> input = noise(4 * 44100);
+    std::vector<float> reference = processChain(config, 5.0f, false, input, kBlockSize);
+    for (size_t blockSize : {1, 37, 4096}) {
+        std::vector<float> output = processChain(config, 5.0f, false, input, blockSize);
+        size_t differing = 0;
+        for (size_t i = 0; i < input.size(); ++i) {
+            differing += output[i] != reference[i] ? 1 : 0;
+        }
+        report("block " + std::to_string(blockSize) + " mismatches", std::string(config.name) + " +5",
+               static_cast<double>(differing), "samples", 0.0, differing == 0);
+    }
+}
+
+void checkFormants(const EngineConfig& config) {
+    // A shifted vowel's envelope must end up closer to the input's with
+    // formant preservation than without; the limit is the uncorrected error
+    std::vector<float> input = vowel(3 * 44100);
+    std::vector<double> reference = bandLevels(input);
+    for (float shift : {-5.0f, 7.0f}) {
+        double plain = envelopeError(reference, bandLevels(processChain(config, shift, false, input)));
+        double preserved = envelopeError(reference, bandLevels(processChain(config, shift, true, input)));
+        std::string label = std::string(config.name) + (shift > 0 ? " +" : " ") + std::to_string(static_cast<int>(shift));
+        report("formant envelope error", label, preserved, "dB", plain, preserved < plain);
+    }
+    
+    // Envelope updates fall on fixed hops, so host block size still doesn't
+    // matter
+    std::vector<float> small = processChain(config, 5.0f, true, input, 64);
+    std::vector<float> large = processChain(config, 5.0f, true, input, 1024);
+    size_t differing = 0;
+    for (size_t i = 0; i < input.size(); ++i) {
+        differing += small[i] != large[i] ? 1 : 0;
+    }
+    report("block 64 vs 1024 mismatches", std::string(config.name) + " +5 formants",
+           static_cast<double>(differing), "samples", 0.0, differing == 0);
+}
+
+} // namespace
+
+int main() {
+    std::cout << std::left << std::setw(28) << "check" << std::setw(24) << "config" << std::right
+              << std::setw(12) << "value" << " " << std::left << std::setw(7) << "unit" << std::right
+              << std::setw(10) << "limit" << "  result\n";
+    std::cout << std::fixed << std::setprecision(2);
+    
+    checkFFT();
+    for (const EngineConfig& config : kEngines) {
+        checkPitch(config);
+        checkAliasing(config);
+        checkLatency(config);
+        checkBlockSizes(config);
+        checkFormants(config);
+    }
+    
+    std::cout << (failures == 0 ? "All checks passed\n" : std::to_string(failures) + " checks failed\n");
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+// Measures how many concurrent realtime pitch-shift streams one machine
+// sustains: each step doubles the voice count and reports the worst-case
+// block time against the 256-frame / 44.1 kHz deadline.
+#include "VoicePool.h"
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+int main(int argc, char* argv[]) {
+    const size_t blockSize = 256;
+    const float sampleRate = 44100.0f;
+    const size_t blocksPerRun = 1000;
+    size_t numWorkers = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 0;
+    size_t maxVoices = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024;
+    
+    double deadline = blockSize / sampleRate;
+    std::cout << "VoicePool: " << blockSize << " frames at " << sampleRate << " Hz, deadline "
+              << (deadline * 1e3) << " ms, " << blocksPerRun << " blocks per run\n";
+    std::cout << std::setw(8) << "voices" << std::setw(9) << "workers" << std::setw(12) << "mean (ms)"
+              << std::setw(12) << "max (ms)" << std::setw(10) << "load" << std::setw(10) << "misses" << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    
+    size_t sustained = 0;
+    for (size_t numVoices = 16; numVoices <= maxVoices; numVoices *= 2) {
+        VoicePool pool(numVoices, blockSize, sampleRate, numWorkers);
+        
+        // Spread ratios over the full range so voices do unequal work
+        for (size_t v = 0; v < numVoices; ++v) {
+            pool.getVoice(v).setPitchRatio(0.5f + 1.5f * v / numVoices);
+            float* input = pool.getInput(v);
+            for (size_t i = 0; i < blockSize; ++i) {
+                input[i] = std::sin(0.05f * (i + v));
+            }
+        }
+        
+        if (pool.getNumPinnedWorkers() + 1 < pool.getNumWorkers()) {
+            std::cerr << "Warning: pinned " << pool.getNumPinnedWorkers() << " of "
+                      << (pool.getNumWorkers() - 1) << " helper workers\n";
+        }
+        
+        double total = 0.0;
+        for (size_t b = 0; b < blocksPerRun; ++b) {
+            pool.processBlock(blockSize);
+            total += pool.getLastBlockSeconds();
+        }
+        
+        double mean = total / blocksPerRun;
+        std::cout << std::setw(8) << numVoices << std::setw(9) << pool.getNumWorkers()
+                  << std::setw(12) << (mean * 1e3) << std::setw(12) << (pool.getMaxBlockSeconds() * 1e3)
+                  << std::setw(9) << std::setprecision(1) << (100.0 * mean / deadline) << "%"
+                  << std::setw(10) << pool.getDeadlineMisses() << std::setprecision(3) << "\n";
+        
+        if (pool.getDeadlineMisses() == 0) {
+            sustained = numVoices;
+        } else {
+            break;
+        }
+    }
+    
+    std::cout << "Sustained without deadline misses: " << sustained << " streams\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include "Arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Owning array aligned for SIMD loads and stores (32 bytes covers AVX).
+// Value-initialized; only resize() allocates. While an Arena::Scope is active
+// the storage is carved from that arena instead of the heap.
+template <typename T>
+class AlignedArray {
+public:
+    static_assert(std::is_trivially_destructible<T>::value, "AlignedArray never runs destructors");
+    static constexpr size_t kAlignment = 32;
+    
+    explicit AlignedArray(size_t size = 0) : data_(nullptr), size_(0), fromArena_(false) { resize(size); }
+    ~AlignedArray() { release(); }
+    
+    AlignedArray(const AlignedArray&) = delete;
+    AlignedArray& operator=(const AlignedArray&) = delete;
+    
+    void resize(size_t size) {
+        release();
+        if (size > 0) {
+            size_t bytes = size * sizeof(T);
+            Arena* arena = Arena::current();
+            void* block = arena ? arena->allocate(bytes) : nullptr;
+            fromArena_ = block != nullptr;
+            if (!block) {
+                if (arena) {
+                    arena->addOverflow(bytes);
+                }
+                block = ::operator new(bytes, std::align_val_t(kAlignment));
+            }
+            data_ = static_cast<T*>(block);
+            std::fill(data_, data_ + size, T());
+        }
+        size_ = size;
+    }
+    
+    // Resize and fill with value
+    void assign(size_t size, const T& value) {
+        resize(size);
+        std::fill(data_, data_ + size, value);
+    }
+    
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    size_t size() const { return size_; }
+    T& operator[](size_t index) { return data_[index]; }
+    const T& operator[](size_t index) const { return data_[index]; }
+    
+    T* begin() { return data_; }
+    T* end() { return data_ + size_; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    
+private:
+    void release() {
+        if (data_ && !fromArena_) {
+            ::operator delete(data_, std::align_val_t(kAlignment));
+        }
+        data_ = nullptr;
+        fromArena_ = false;
+    }
+    
+    T* data_;
+    size_t size_;
+    bool fromArena_;
+};
+
+using AlignedBuffer = AlignedArray<float>;
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "Arena.h"
+#include <cstring>
+#include <new>
+
+namespace {
+thread_local Arena* currentArena = nullptr;
+}
+
+Arena::Arena(size_t capacity)
+    : data_(nullptr)
+    , capacity_(roundUp(capacity))
+    , used_(0)
+    , overflow_(0) {
+    if (capacity_ > 0) {
+        data_ = static_cast<unsigned char*>(::operator new(capacity_, std::align_val_t(kAlignment)));
+        // Touch every page now so first use on the audio thread doesn't fault
+        std::memset(data_, 0, capacity_);
+    }
+}
+
+Arena::~Arena() {
+    if (data_) {
+        ::operator delete(data_, std::align_val_t(kAlignment));
+    }
+}
+
+void* Arena::allocate(size_t bytes) {
+    bytes = roundUp(bytes);
+    if (bytes > capacity_ - used_) {
+        return nullptr;
+    }
+    void* block = data_ + used_;
+    used_ += bytes;
+    return block;
+}
+
+Arena* Arena::current() {
+    return currentArena;
+}
+
+Arena::Scope::Scope(Arena* arena)
+    : previous_(currentArena) {
+    currentArena = arena;
+}
+
+Arena::Scope::~Scope() {
+    currentArena = previous_;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+
+// Fixed-capacity bump allocator for DSP state. One block is allocated up
+// front; AlignedArray buffers sized while an Arena::Scope is active on the
+// current thread are carved from it and released all at once with the arena.
+// Requests that don't fit fall back to the heap and are tallied as overflow,
+// so a dry run against an empty arena measures the capacity a configuration
+// needs.
+class Arena {
+public:
+    // Every allocation starts on its own cache line
+    static constexpr size_t kAlignment = 64;
+    
+    explicit Arena(size_t capacity);
+    ~Arena();
+    
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    
+    // nullptr when the request doesn't fit; never touches the heap
+    void* allocate(size_t bytes);
+    void addOverflow(size_t bytes) { overflow_ += roundUp(bytes); }
+    
+    size_t getCapacity() const { return capacity_; }
+    size_t getUsed() const { return used_; }
+    size_t getOverflow() const { return overflow_; }
+    
+    // Arena that AlignedArray allocations on this thread draw from, or null
+    static Arena* current();
+    
+    // Routes allocations on this thread to arena (null = heap) until the
+    // scope ends; scopes nest
+    class Scope {
+    public:
+        explicit Scope(Arena* arena);
+        ~Scope();
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+    private:
+        Arena* previous_;
+    };
+    
+private:
+    static size_t roundUp(size_t bytes) { return (bytes + kAlignment - 1) & ~(kAlignment - 1); }
+    
+    unsigned char* data_;
+    size_t capacity_;
+    size_t used_;
+    size_t overflow_;
+};
\ No newline at end of file
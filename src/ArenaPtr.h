@@ -0,0 +1,77 @@
+#pragma once
+#include "Arena.h"
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Destroys objects built by makeArenaObject/makeArenaArray. Storage carved
+// from an arena goes back with the arena; storage that overflowed to the heap
+// is freed here.
+class ArenaDeleter {
+public:
+    ArenaDeleter() : heapBlock_(nullptr), count_(1) {}
+    ArenaDeleter(void* heapBlock, size_t count) : heapBlock_(heapBlock), count_(count) {}
+    
+    template <typename T>
+    void operator()(T* objects) const {
+        for (size_t i = count_; i > 0; --i) {
+            objects[i - 1].~T();
+        }
+        if (heapBlock_) {
+            ::operator delete(heapBlock_, std::align_val_t(Arena::kAlignment));
+        }
+    }
+    
+private:
+    void* heapBlock_;
+    size_t count_;
+};
+
+// Owning pointer to objects placed the way AlignedArray places its storage:
+// in the current thread's arena while a Scope is active, otherwise on the
+// heap (tallied as overflow when an arena is active but full). Converts from
+// derived to base like std::unique_ptr, for single objects.
+template <typename T>
+using ArenaPtr = std::unique_ptr<T, ArenaDeleter>;
+
+namespace arena_detail {
+
+// Storage for count objects of type T; heapBlock is set when it came from
+// the heap rather than the arena
+template <typename T>
+void* allocate(size_t count, void*& heapBlock) {
+    static_assert(alignof(T) <= Arena::kAlignment, "Arena storage is only cache-line aligned");
+    size_t bytes = count * sizeof(T);
+    Arena* arena = Arena::current();
+    void* block = arena ? arena->allocate(bytes) : nullptr;
+    heapBlock = nullptr;
+    if (!block) {
+        if (arena) {
+            arena->addOverflow(bytes);
+        }
+        block = heapBlock = ::operator new(bytes, std::align_val_t(Arena::kAlignment));
+    }
+    return block;
+}
+
+} // namespace arena_detail
+
+template <typename T, typename... Args>
+ArenaPtr<T> makeArenaObject(Args&&... args) {
+    void* heapBlock;
+    void* block = arena_detail::allocate<T>(1, heapBlock);
+    T* object = new (block) T(std::forward<Args>(args)...);
+    return ArenaPtr<T>(object, ArenaDeleter(heapBlock, 1));
+}
+
+// count objects, each constructed from the same arguments
+template <typename T, typename... Args>
+ArenaPtr<T[]> makeArenaArray(size_t count, const Args&... args) {
+    void* heapBlock;
+    T* objects = static_cast<T*>(arena_detail::allocate<T>(count, heapBlock));
+    for (size_t i = 0; i < count; ++i) {
+        new (objects + i) T(args...);
+    }
+    return ArenaPtr<T[]>(objects, ArenaDeleter(heapBlock, count));
+}
\ No newline at end of file
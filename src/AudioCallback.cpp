@@ -0,0 +1,30 @@
+#include "AudioCallback.h"
+#include <chrono>
+#include <cstring>
+#include "RealtimeGuard.h"
+
+void processAudioCallback(AudioData& data, const float* input, float* output, unsigned int numFrames,
+                          bool inputOverflow, bool outputUnderflow) {
+    // Timed with a steady clock; printing is left to the stats reporter thread
+    auto blockStart = std::chrono::steady_clock::now();
+    RealtimeGuard guard;  // Counts allocations and blocking calls in debug builds
+    
+    if (input && output) {
+        // Picks up parameter changes, tracks, shifts and applies gain
+        data.processor->processInterleaved(input, output, numFrames);
+        
+        // Hand output to the spectral meter's thread; FFT and drawing happen there
+        if (data.spectralMeter) {
+            data.spectralMeter->pushSamples(output, numFrames, data.numChannels);
+        }
+    } else {
+        // Fill with silence if no input/output buffers
+        if (output) {
+            std::memset(output, 0, numFrames * data.numChannels * sizeof(float));
+        }
+    }
+    
+    auto elapsed = std::chrono::steady_clock::now() - blockStart;
+    data.stats->recordBlock(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                            numFrames, data.sampleRate, inputOverflow, outputUnderflow);
+}
\ No newline at end of file
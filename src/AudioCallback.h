@@ -0,0 +1,21 @@
+#pragma once
+#include "PitchProcessor.h"
+#include "SpectralMeter.h"
+#include "CallbackStats.h"
+
+class RealtimeSetup;
+
+struct AudioData {
+    PitchProcessor* processor;
+    SpectralMeter* spectralMeter;  // Null unless the meter is enabled
+    CallbackStats* stats;
+    RealtimeSetup* realtime;  // Null unless --realtime; the RtAudio callback reports to it
+    unsigned int sampleRate;
+    unsigned int numChannels;
+};
+
+// Everything the audio callback does for one block of interleaved frames:
+// the DSP chain, the meter hand-off and timing. Kept free of RtAudio so
+// benchmarks can drive the same path.
+void processAudioCallback(AudioData& data, const float* input, float* output, unsigned int numFrames,
+                          bool inputOverflow, bool outputUnderflow);
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "CallbackStats.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+LatencyHistogram::LatencyHistogram()
+    : count_(0)
+    , max_(0) {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - kSubBucketBits;
+    size_t sub = static_cast<size_t>(value >> shift) & (kSubBuckets - 1);
+    return static_cast<size_t>(shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < kSubBuckets) {
+        return index;
+    }
+    int shift = static_cast<int>(index / kSubBuckets) - 1;
+    uint64_t sub = index % kSubBuckets;
+    return ((kSubBuckets + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    // Only the audio thread writes, so plain load/store avoids locked RMW ops
+    auto& bucket = buckets_[bucketIndex(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count_.store(count_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    uint64_t total = 0;
+    for (const auto& bucket : buckets_) {
+        total += bucket.load(std::memory_order_relaxed);
+    }
+    if (total == 0) return 0;
+    
+    uint64_t rank = static_cast<uint64_t>(std::max(1.0, percentile / 100.0 * total + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kNumBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), getMax());
+        }
+    }
+    return getMax();
+}
+
+CallbackStats::CallbackStats()
+    : inputOverflows_(0)
+    , outputUnderflows_(0) {
+}
+
+void CallbackStats::recordBlock(uint64_t processingNs, unsigned int numFrames, double sampleRate,
+                                bool inputOverflow, bool outputUnderflow) {
+    processingNs_.record(processingNs);
+    
+    double blockNs = numFrames * 1e9 / sampleRate;
+    if (blockNs > 0.0) {
+        loadPer10k_.record(static_cast<uint64_t>(processingNs * 10000.0 / blockNs));
+    }
+    
+    if (inputOverflow) {
+        inputOverflows_.store(inputOverflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    if (outputUnderflow) {
+        outputUnderflows_.store(outputUnderflows_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void CallbackStats::printSummary(std::ostream& stream) const {
+    // Format locally so the caller's stream flags are left alone
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(1)
+        << "Callback: " << processingNs_.getCount() << " blocks"
+        << " | time p50 " << processingNs_.getPercentile(50) / 1000.0 << " us"
+        << ", p99 " << processingNs_.getPercentile(99) / 1000.0 << " us"
+        << ", max " << processingNs_.getMax() / 1000.0 << " us"
+        << " | load p50 " << loadPer10k_.getPercentile(50) / 100.0 << "%"
+        << ", p99 " << loadPer10k_.getPercentile(99) / 100.0 << "%"
+        << ", max " << loadPer10k_.getMax() / 100.0 << "%"
+        << " | overflows " << getInputOverflows()
+        << ", underflows " << getOutputUnderflows() << "\n";
+    stream << out.str();
+}
+
+void CallbackStats::writeJson(std::ostream& stream) const {
+    std::ostringstream out;
+    out << "{\n"
+        << "  \"blocks\": " << processingNs_.getCount() << ",\n"
+        << "  \"processing_ns\": {\"p50\": " << processingNs_.getPercentile(50)
+        << ", \"p99\": " << processingNs_.getPercentile(99)
+        << ", \"max\": " << processingNs_.getMax() << "},\n"
+        << "  \"load_fraction\": {\"p50\": " << loadPer10k_.getPercentile(50) / 10000.0
+        << ", \"p99\": " << loadPer10k_.getPercentile(99) / 10000.0
+        << ", \"max\": " << loadPer10k_.getMax() / 10000.0 << "},\n"
+        << "  \"input_overflows\": " << getInputOverflows() << ",\n"
+        << "  \"output_underflows\": " << getOutputUnderflows() << "\n"
+        << "}\n";
+    stream << out.str();
+}
+
+StatsReporter::StatsReporter(const CallbackStats& stats, double intervalSeconds, bool printToConsole,
+                             const std::string& statsPath)
+    : stats_(stats)
+    , intervalSeconds_(intervalSeconds)
+    , printToConsole_(printToConsole)
+    , statsPath_(statsPath)
+    , running_(false) {
+}
+
+StatsReporter::~StatsReporter() {
+    stop();
+}
+
+void StatsReporter::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&StatsReporter::run, this);
+}
+
+void StatsReporter::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    report();
+}
+
+void StatsReporter::run() {
+    using Clock = std::chrono::steady_clock;
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(intervalSeconds_));
+    auto nextReport = Clock::now() + interval;
+    
+    // Wake often enough that stop() doesn't wait a whole interval
+    while (running_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if (Clock::now() >= nextReport) {
+            report();
+            nextReport += interval;
+        }
+    }
+}
+
+void StatsReporter::report() {
+    if (printToConsole_) {
+        stats_.printSummary(std::cerr);
+    }
+    if (!statsPath_.empty()) {
+        std::ofstream file(statsPath_, std::ios::trunc);
+        if (file) {
+            stats_.writeJson(file);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// Log-linear histogram (8 linear steps per power of two, so about 12%
+// resolution) for one writer thread and any number of readers. Recording is
+// a few relaxed atomic loads/stores: no locks, no allocation.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    
+    void record(uint64_t value);  // Single writer only
+    
+    uint64_t getCount() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t getMax() const { return max_.load(std::memory_order_relaxed); }
+    // Upper bound of the bucket holding the given percentile (0-100)
+    uint64_t getPercentile(double percentile) const;
+    
+private:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kNumBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+    
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+    
+    std::atomic<uint64_t> buckets_[kNumBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> max_;
+};
+
+// Per-block measurements taken inside the audio callback
+class CallbackStats {
+public:
+    CallbackStats();
+    
+    // Audio thread: processing time for one block and the stream status flags
+    void recordBlock(uint64_t processingNs, unsigned int numFrames, double sampleRate,
+                     bool inputOverflow, bool outputUnderflow);
+    
+    const LatencyHistogram& getProcessingTime() const { return processingNs_; }
+    // Processing time as a fraction of the block's duration, in 1/10000ths
+    const LatencyHistogram& getLoad() const { return loadPer10k_; }
+    uint64_t getInputOverflows() const { return inputOverflows_.load(std::memory_order_relaxed); }
+    uint64_t getOutputUnderflows() const { return outputUnderflows_.load(std::memory_order_relaxed); }
+    
+    void printSummary(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+    
+private:
+    LatencyHistogram processingNs_;
+    LatencyHistogram loadPer10k_;
+    std::atomic<uint64_t> inputOverflows_;
+    std::atomic<uint64_t> outputUnderflows_;
+};
+
+// Non-realtime thread that periodically prints CallbackStats to stderr and/or
+// rewrites a JSON stats file, so nothing is ever printed from the callback
+class StatsReporter {
+public:
+    StatsReporter(const CallbackStats& stats, double intervalSeconds, bool printToConsole,
+                  const std::string& statsPath);
+    ~StatsReporter();
+    
+    void start();
+    void stop();  // Joins the thread and writes a final report
+    
+private:
+    void run();
+    void report();
+    
+    const CallbackStats& stats_;
+    double intervalSeconds_;
+    bool printToConsole_;
+    std::string statsPath_;
+    std::thread thread_;
+    std::atomic<bool> running_;
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "ControlInput.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+// Puts the terminal in unbuffered, no-echo mode for the lifetime of the object
+class RawTerminal {
+public:
+    RawTerminal() : active_(tcgetattr(STDIN_FILENO, &saved_) == 0) {
+        if (!active_) return;
+        termios raw = saved_;
+        raw.c_lflag &= ~(ICANON | ECHO);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    
+    ~RawTerminal() {
+        if (active_) {
+            tcsetattr(STDIN_FILENO, TCSANOW, &saved_);
+        }
+    }
+    
+private:
+    termios saved_;
+    bool active_;
+};
+
+// Set by SIGINT/SIGTERM while a ControlInput exists; the control loop polls it
+volatile std::sig_atomic_t quitRequested = 0;
+pthread_t controlThread;
+
+void requestQuit(int signal) {
+    quitRequested = 1;
+    // The signal may land on an audio or meter thread; pass it on so the
+    // control thread's blocking read returns EINTR
+    if (!pthread_equal(pthread_self(), controlThread)) {
+        pthread_kill(controlThread, signal);
+    }
+}
+
+const float kMixStep = 0.05f;
+const float kGainStep = 0.1f;
+
+} // namespace
+
+ControlInput::ControlInput(ParameterMailbox& mailbox, float semitones, float mixLevel,
+                           float outputGain, bool showStatus)
+    : mailbox_(mailbox)
+    , semitones_(semitones)
+    , mixLevel_(mixLevel)
+    , outputGain_(outputGain)
+    , showStatus_(showStatus) {
+    // No SA_RESTART, so blocking reads are interrupted rather than resumed
+    quitRequested = 0;
+    controlThread = pthread_self();
+    struct sigaction action = {};
+    action.sa_handler = requestQuit;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &savedInterrupt_);
+    sigaction(SIGTERM, &action, &savedTerminate_);
+}
+
+ControlInput::~ControlInput() {
+    sigaction(SIGINT, &savedInterrupt_, nullptr);
+    sigaction(SIGTERM, &savedTerminate_, nullptr);
+}
+
+void ControlInput::printKeyHelp() {
+    std::cout << "Keys: +/- pitch (semitone), 0 reset pitch, [/] mix, </> gain, Enter or q to quit"
+              << std::endl;
+}
+
+void ControlInput::run() {
+    if (isatty(STDIN_FILENO)) {
+        runKeys();
+    } else {
+        runCommands();
+    }
+}
+
+void ControlInput::runKeys() {
+    RawTerminal raw;
+    printStatus();
+    
+    char key;
+    while (!quitRequested) {
+        ssize_t count = read(STDIN_FILENO, &key, 1);
+        if (count < 0 && errno == EINTR) continue;
+        if (count != 1) break;
+        switch (key) {
+            case '+': case '=': setSemitones(semitones_ + 1.0f); break;
+            case '-': case '_': setSemitones(semitones_ - 1.0f); break;
+            case '0': setSemitones(0.0f); break;
+            case ']': setMixLevel(mixLevel_ + kMixStep); break;
+            case '[': setMixLevel(mixLevel_ - kMixStep); break;
+            case '>': case '.': setOutputGain(outputGain_ + kGainStep); break;
+            case '<': case ',': setOutputGain(outputGain_ - kGainStep); break;
+            case '\n': case 'q': case 'Q':
+                if (showStatus_) std::cout << std::endl;
+                return;
+            default: break;
+        }
+    }
+    if (quitRequested && showStatus_) std::cout << std::endl;
+}
+
+void ControlInput::runCommands() {
+    std::string line;
+    while (!quitRequested && std::getline(std::cin, line)) {
+        if (!handleCommand(line.c_str())) return;
+    }
+}
+
+bool ControlInput::handleCommand(const char* line) {
+    char command[16];
+    float value;
+    int fields = std::sscanf(line, "%15s %f", command, &value);
+    if (fields < 1) return true;  // Blank line
+    
+    if (std::strcmp(command, "quit") == 0) {
+        return false;
+    } else if (fields == 2 && std::strcmp(command, "pitch") == 0) {
+        setSemitones(value);
+    } else if (fields == 2 && std::strcmp(command, "mix") == 0) {
+        setMixLevel(value);
+    } else if (fields == 2 && std::strcmp(command, "gain") == 0) {
+        setOutputGain(value);
+    } else {
+        std::cerr << "Unknown command: " << line << std::endl;
+        std::cerr << "Commands: pitch <semitones>, mix <0..1>, gain <0.1..2>, quit" << std::endl;
+    }
+    return true;
+}
+
+void ControlInput::setSemitones(float semitones) {
+    semitones_ = std::max(-12.0f, std::min(12.0f, semitones));
+    mailbox_.post(Parameter::PitchRatio, std::pow(2.0f, semitones_ / 12.0f));
+    printStatus();
+}
+
+void ControlInput::setMixLevel(float mix) {
+    mixLevel_ = std::max(0.0f, std::min(1.0f, mix));
+    mailbox_.post(Parameter::Mix, mixLevel_);
+    printStatus();
+}
+
+void ControlInput::setOutputGain(float gain) {
+    outputGain_ = std::max(0.1f, std::min(2.0f, gain));
+    mailbox_.post(Parameter::Gain, outputGain_);
+    printStatus();
+}
+
+void ControlInput::printStatus() {
+    if (!showStatus_) return;
+    std::printf("\rPitch: %+5.1f st  Mix: %3.0f%% wet  Gain: %.2fx   ",
+                semitones_, mixLevel_ * 100.0f, outputGain_);
+    std::fflush(stdout);
+}
\ No newline at end of file
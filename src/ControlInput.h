@@ -0,0 +1,44 @@
+#pragma once
+#include "ParameterMailbox.h"
+#include <csignal>
+
+// Live parameter control from the terminal, posted to the audio thread via a
+// ParameterMailbox. On a TTY single keys adjust parameters; otherwise stdin is
+// read as a line protocol, one command per line:
+//   pitch <semitones> | mix <0..1> | gain <0.1..2> | quit
+// While it exists, SIGINT and SIGTERM only ask the control loop to return, so
+// Ctrl-C still restores the terminal and lets the caller shut down cleanly.
+// Construct and run it on the same thread.
+class ControlInput {
+public:
+    ControlInput(ParameterMailbox& mailbox, float semitones, float mixLevel, float outputGain,
+                 bool showStatus);
+    ~ControlInput();
+    
+    ControlInput(const ControlInput&) = delete;
+    ControlInput& operator=(const ControlInput&) = delete;
+    
+    // Blocks until the user quits (Enter or q, "quit", end of input, or
+    // SIGINT/SIGTERM)
+    void run();
+    
+    static void printKeyHelp();
+    
+private:
+    void runKeys();
+    void runCommands();
+    bool handleCommand(const char* line);
+    
+    void setSemitones(float semitones);
+    void setMixLevel(float mix);
+    void setOutputGain(float gain);
+    void printStatus();
+    
+    ParameterMailbox& mailbox_;
+    float semitones_;
+    float mixLevel_;
+    float outputGain_;
+    bool showStatus_;
+    struct sigaction savedInterrupt_;
+    struct sigaction savedTerminate_;
+};
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include "FFT.h"
+#include <cmath>
+
+namespace {
+std::complex<float> unitRoot(size_t k, size_t n) {
+    double angle = -2.0 * M_PI * static_cast<double>(k) / static_cast<double>(n);
+    return std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+}
+}
+
+FFTPlan::FFTPlan(size_t size)
+    : size_(size)
+    , leadingRadix2_(false) {
+    
+    size_t bits = 0;
+    while ((size_t(1) << bits) < size_) {
+        bits++;
+    }
+    leadingRadix2_ = (bits % 2) == 1;
+    
+    auto reverse = [bits](size_t i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        return reversed;
+    };
+    
+    // Tables are sized exactly up front, so they can live in a fixed arena
+    size_t numSwaps = 0;
+    for (size_t i = 0; i < size_; ++i) {
+        numSwaps += i < reverse(i) ? 1 : 0;
+    }
+    swaps_.resize(numSwaps);
+    numSwaps = 0;
+    for (size_t i = 0; i < size_; ++i) {
+        size_t reversed = reverse(i);
+        if (i < reversed) {
+            swaps_[numSwaps++] = std::make_pair(static_cast<uint32_t>(i), static_cast<uint32_t>(reversed));
+        }
+    }
+    
+    size_t numTwiddles = 0;
+    for (size_t quarter = leadingRadix2_ ? 2 : 1; quarter * 4 <= size_; quarter *= 4) {
+        numTwiddles += 3 * quarter;
+    }
+    twiddles_.resize(numTwiddles);
+    std::complex<float>* w = twiddles_.data();
+    for (size_t quarter = leadingRadix2_ ? 2 : 1; quarter * 4 <= size_; quarter *= 4) {
+        for (size_t j = 0; j < quarter; ++j) {
+            *w++ = unitRoot(j, quarter * 4);
+            *w++ = unitRoot(2 * j, quarter * 4);
+            *w++ = unitRoot(3 * j, quarter * 4);
+        }
+    }
+}
+
+void FFTPlan::permute(std::complex<float>* data) const {
+    for (const auto& swap : swaps_) {
+        std::swap(data[swap.first], data[swap.second]);
+    }
+}
+
+void FFTPlan::transform(std::complex<float>* data) const {
+    permute(data);
+    
+    size_t quarter = 1;
+    if (leadingRadix2_) {
+        for (size_t i = 0; i < size_; i += 2) {
+            std::complex<float> u = data[i];
+            std::complex<float> v = data[i + 1];
+            data[i] = u + v;
+            data[i + 1] = u - v;
+        }
+        quarter = 2;
+    }
+    
+    // Each radix-4 pass fuses two radix-2 stages over blocks of 4 * quarter
+    const std::complex<float>* w = twiddles_.data();
+    for (; quarter * 4 <= size_; quarter *= 4) {
+        size_t blockSize = quarter * 4;
+        for (size_t start = 0; start < size_; start += blockSize) {
+            std::complex<float>* x = data + start;
+            for (size_t j = 0; j < quarter; ++j) {
+                std::complex<float> a = x[j];
+                std::complex<float> b = x[j + quarter] * w[3 * j + 1];
+                std::complex<float> c = x[j + 2 * quarter] * w[3 * j];
+                std::complex<float> d = x[j + 3 * quarter] * w[3 * j + 2];
+                
+                std::complex<float> t0 = a + b;
+                std::complex<float> t1 = a - b;
+                std::complex<float> t2 = c + d;
+                std::complex<float> diff = c - d;
+                std::complex<float> t3(diff.imag(), -diff.real());  // (c - d) * -i
+                
+                x[j] = t0 + t2;
+                x[j + quarter] = t1 + t3;
+                x[j + 2 * quarter] = t0 - t2;
+                x[j + 3 * quarter] = t1 - t3;
+            }
+        }
+        w += 3 * quarter;
+    }
+}
+
+void FFTPlan::forward(std::complex<float>* data) const {
+    transform(data);
+}
+
+void FFTPlan::inverse(std::complex<float>* data) const {
+    // IFFT(x) = conj(FFT(conj(x))) / N
+    for (size_t i = 0; i < size_; ++i) {
+        data[i] = std::conj(data[i]);
+    }
+    transform(data);
+    const float scale = 1.0f / size_;
+    for (size_t i = 0; i < size_; ++i) {
+        data[i] = std::conj(data[i]) * scale;
+    }
+}
+
+RealFFTPlan::RealFFTPlan(size_t size)
+    : size_(size)
+    , half_(size / 2) {
+    splitTwiddles_.resize(size_ / 2);
+    for (size_t k = 0; k < size_ / 2; ++k) {
+        splitTwiddles_[k] = unitRoot(k, size_);
+    }
+    work_.resize(size_ / 2);
+}
+
+void RealFFTPlan::forward(const float* input, std::complex<float>* spectrum) {
+    const size_t half = size_ / 2;
+    
+    // Pack even samples into the real part and odd samples into the imaginary
+    for (size_t i = 0; i < half; ++i) {
+        work_[i] = std::complex<float>(input[2 * i], input[2 * i + 1]);
+    }
+    half_.forward(work_.data());
+    
+    // Separate the even/odd spectra and combine them with one more butterfly
+    spectrum[0] = std::complex<float>(work_[0].real() + work_[0].imag(), 0.0f);
+    spectrum[half] = std::complex<float>(work_[0].real() - work_[0].imag(), 0.0f);
+    for (size_t k = 1; k < half; ++k) {
+        std::complex<float> z = work_[k];
+        std::complex<float> zMirror = std::conj(work_[half - k]);
+        std::complex<float> even = 0.5f * (z + zMirror);
+        std::complex<float> odd = std::complex<float>(0.0f, -0.5f) * (z - zMirror);
+        spectrum[k] = even + splitTwiddles_[k] * odd;
+    }
+}
+
+void RealFFTPlan::inverse(const std::complex<float>* spectrum, float* output) {
+    const size_t half = size_ / 2;
+    
+    for (size_t k = 0; k < half; ++k) {
+        std::complex<float> x = spectrum[k];
+        std::complex<float> xMirror = std::conj(spectrum[half - k]);
+        std::complex<float> even = 0.5f * (x + xMirror);
+        std::complex<float> odd = 0.5f * (x - xMirror) * std::conj(splitTwiddles_[k]);
+        work_[k] = even + std::complex<float>(0.0f, 1.0f) * odd;
+    }
+    half_.inverse(work_.data());
+    
+    for (size_t i = 0; i < half; ++i) {
+        output[2 * i] = work_[i].real();
+        output[2 * i + 1] = work_[i].imag();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include <complex>
+#include <cstdint>
+#include <utility>
+
+// Precomputed in-place complex FFT for one power-of-two size. Twiddles and
+// the bit-reversal permutation are computed once (in double precision) at
+// construction; transforms never allocate. Stages run as radix-4 butterflies,
+// with one leading radix-2 stage when log2(size) is odd.
+class FFTPlan {
+public:
+    explicit FFTPlan(size_t size);
+    
+    void forward(std::complex<float>* data) const;
+    void inverse(std::complex<float>* data) const;  // Scaled by 1/size
+    
+    size_t getSize() const { return size_; }
+    
+private:
+    void permute(std::complex<float>* data) const;
+    void transform(std::complex<float>* data) const;
+    
+    size_t size_;
+    bool leadingRadix2_;
+    AlignedArray<std::pair<uint32_t, uint32_t>> swaps_;
+    
+    // Per radix-4 stage, (w, w^2, w^3) for each butterfly, stored contiguously
+    AlignedArray<std::complex<float>> twiddles_;
+};
+
+// Real-input FFT of a power-of-two size, computed as a half-size complex FFT
+// plus a split pass. Spectra hold size/2 + 1 bins (DC through Nyquist).
+class RealFFTPlan {
+public:
+    explicit RealFFTPlan(size_t size);
+    
+    void forward(const float* input, std::complex<float>* spectrum);
+    void inverse(const std::complex<float>* spectrum, float* output);  // Scaled by 1/size
+    
+    size_t getSize() const { return size_; }
+    size_t getNumBins() const { return size_ / 2 + 1; }
+    
+private:
+    size_t size_;
+    FFTPlan half_;
+    AlignedArray<std::complex<float>> splitTwiddles_;
+    AlignedArray<std::complex<float>> work_;
+};
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "FormantCorrector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 1024 samples at 44.1 kHz: a few pitch periods, short against a vowel
+const float kWindowMs = 1024.0f * 1000.0f / 44100.0f;
+// Gaussian lag window width; widens envelope peaks so high voices, whose
+// harmonics sample the envelope sparsely, aren't fitted harmonic by harmonic
+const double kLagWindowHz = 80.0;
+// White-noise floor, about -40 dB under the signal, keeps valleys shallow
+const double kNoiseFloor = 1e-4;
+// Windows quieter than this (mean square) get a flat envelope
+const double kSilenceEnergy = 1e-9;
+// Bounds on the level correction between whitening and recoloring
+const float kMinGain = 0.125f;
+const float kMaxGain = 8.0f;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+// Eight independent accumulators so the sum vectorizes without reassociating
+// a single one; n is a multiple of eight
+float dotProduct(const float* a, const float* b, size_t n) {
+    float acc[8] = {};
+    for (size_t k = 0; k < n; k += 8) {
+        for (size_t j = 0; j < 8; ++j) {
+            acc[j] += a[k + j] * b[k + j];
+        }
+    }
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+size_t nextPowerOfTwo(size_t value) {
+    size_t size = 1;
+    while (size < value) {
+        size *= 2;
+    }
+    return size;
+}
+} // namespace
+
+FormantCorrector::FormantCorrector(float sampleRate, size_t numChannels, size_t maxBlockSize, size_t maxLatency)
+    : numChannels_(std::max<size_t>(1, numChannels))
+    // Even number of ramp steps, so the hop is a whole number of them
+    , windowSize_(roundUp(std::max<size_t>(4 * kOrder, std::lround(kWindowMs * sampleRate / 1000.0f)),
+                          2 * kRampLength))
+    , hopSize_(windowSize_ / 2)
+    , sinceUpdate_(0)
+    , historyMask_(nextPowerOfTwo(windowSize_ + maxLatency + maxBlockSize) - 1)
+    , inputWrite_(0)
+    , outputWrite_(0)
+    , inputAhead_(0)
+    , maxDelay_(historyMask_ + 1 - windowSize_)
+    , gainFrom_(1.0f)
+    , gainTo_(1.0f) {
+    
+    inputHistory_.assign(historyMask_ + 1, 0.0f);
+    outputHistory_.assign(historyMask_ + 1, 0.0f);
+    frame_.resize(kOrder + windowSize_);
+    window_.resize(windowSize_);
+    for (size_t i = 0; i < windowSize_; ++i) {
+        window_[i] = 0.5f - 0.5f * std::cos(2.0f * static_cast<float>(M_PI) * (i + 0.5f) / windowSize_);
+    }
+    
+    correlation_.resize(kOrder + 1);
+    lagWindow_.resize(kOrder + 1);
+    for (size_t lag = 0; lag <= kOrder; ++lag) {
+        double x = 2.0 * M_PI * kLagWindowHz * lag / sampleRate;
+        lagWindow_[lag] = std::exp(-0.5 * x * x);
+    }
+    lagWindow_[0] += kNoiseFloor;
+    predictor_.resize(kOrder + 1);
+    previous_.resize(kOrder + 1);
+    
+    
+    whitenFrom_.resize(kOrder);
+    whitenTo_.resize(kOrder);
+    colorFrom_.resize(kOrder);
+    colorTo_.resize(kOrder);
+    reflection_.resize(kOrder);
+    
+    // Flat envelopes until the first hop: A(z) = 1, unit gain
+    size_t numSteps = hopSize_ / kRampLength;
+    whitenTable_.resize(numSteps * kTaps);
+    colorTable_.resize(numSteps * kTaps);
+    gainTable_.assign(numSteps, 1.0f);
+    for (size_t step = 0; step < numSteps; ++step) {
+        whitenTable_[step * kTaps + kTaps - 1] = 1.0f;
+        colorTable_[step * kTaps + kTaps - 1] = 1.0f;
+    }
+    
+    inputState_.resize((kTaps - 1) * numChannels_);
+    outputState_.resize((kTaps - 1) * numChannels_);
+    inputTaps_.resize(kTaps - 1 + hopSize_);
+    outputTaps_.resize(kTaps - 1 + hopSize_);
+}
+
+void FormantCorrector::pushInput(const float* input, size_t numFrames) {
+    const float scale = 1.0f / numChannels_;
+    for (size_t i = 0; i < numFrames; ++i) {
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            sum += input[i * numChannels_ + ch];
+        }
+        inputHistory_[inputWrite_] = sum * scale;
+        inputWrite_ = (inputWrite_ + 1) & historyMask_;
+    }
+    inputAhead_ += numFrames;
+}
+
+void FormantCorrector::pushInputPlanar(const float* const* inputs, size_t numFrames) {
+    const float scale = 1.0f / numChannels_;
+    for (size_t i = 0; i < numFrames; ++i) {
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            sum += inputs[ch][i];
+        }
+        inputHistory_[inputWrite_] = sum * scale;
+        inputWrite_ = (inputWrite_ + 1) & historyMask_;
+    }
+    inputAhead_ += numFrames;
+}
+
+void FormantCorrector::process(float* output, size_t numFrames, size_t latency) {
+    const float scale = 1.0f / numChannels_;
+    size_t offset = 0;
+    while (offset < numFrames) {
+        // Split at hop boundaries so envelopes change at the same sample
+        // whatever the block size
+        size_t span = std::min(numFrames - offset, hopSize_ - sinceUpdate_);
+        float* block = output + offset * numChannels_;
+        
+        for (size_t i = 0; i < span; ++i) {
+            float sum = 0.0f;
+            for (size_t ch = 0; ch < numChannels_; ++ch) {
+                sum += block[i * numChannels_ + ch];
+            }
+            outputHistory_[outputWrite_] = sum * scale;
+            outputWrite_ = (outputWrite_ + 1) & historyMask_;
+        }
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            filter(block + ch, numChannels_, span, ch);
+        }
+        
+        offset += span;
+        inputAhead_ -= std::min(inputAhead_, span);
+        sinceUpdate_ += span;
+        if (sinceUpdate_ == hopSize_) {
+            sinceUpdate_ = 0;
+            updateEnvelopes(latency);
+        }
+    }
+}
+
+void FormantCorrector::processPlanar(float* const* outputs, size_t numFrames, size_t latency) {
+    const float scale = 1.0f / numChannels_;
+    size_t offset = 0;
+    while (offset < numFrames) {
+        size_t span = std::min(numFrames - offset, hopSize_ - sinceUpdate_);
+        
+        for (size_t i = 0; i < span; ++i) {
+            float sum = 0.0f;
+            for (size_t ch = 0; ch < numChannels_; ++ch) {
+                sum += outputs[ch][offset + i];
+            }
+            outputHistory_[outputWrite_] = sum * scale;
+            outputWrite_ = (outputWrite_ + 1) & historyMask_;
+        }
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            filter(outputs[ch] + offset, 1, span, ch);
+        }
+        
+        offset += span;
+        inputAhead_ -= std::min(inputAhead_, span);
+        sinceUpdate_ += span;
+        if (sinceUpdate_ == hopSize_) {
+            sinceUpdate_ = 0;
+            updateEnvelopes(latency);
+        }
+    }
+}
+
+// Autocorrelation LPC over the Hann-windowed samples ending at end, solved
+// with Levinson-Durbin for A(z) = 1 + sum a_i z^-i
+float FormantCorrector::analyze(const AlignedBuffer& history, size_t end, float* reflection) {
+    // kOrder zeros lead the frame so every lag reads a full window
+    size_t start = (end - windowSize_) & historyMask_;
+    float* frame = frame_.data() + kOrder;
+    for (size_t i = 0; i < windowSize_; ++i) {
+        frame[i] = history[(start + i) & historyMask_] * window_[i];
+    }
+    for (size_t lag = 0; lag <= kOrder; ++lag) {
+        correlation_[lag] = dotProduct(frame, frame - lag, windowSize_) * lagWindow_[lag];
+    }
+    
+    std::fill(reflection, reflection + kOrder, 0.0f);
+    if (correlation_[0] < kSilenceEnergy * windowSize_) return 1.0f;
+    
+    std::fill(predictor_.begin(), predictor_.end(), 0.0);
+    predictor_[0] = 1.0;
+    double error = correlation_[0];
+    for (size_t m = 1; m <= kOrder; ++m) {
+        double acc = correlation_[m];
+        for (size_t i = 1; i < m; ++i) {
+            acc += predictor_[i] * correlation_[m - i];
+        }
+        double k = -acc / error;
+        std::copy(predictor_.begin(), predictor_.begin() + m, previous_.begin());
+        for (size_t i = 1; i < m; ++i) {
+            predictor_[i] = previous_[i] + k * previous_[m - i];
+        }
+        predictor_[m] = k;
+        reflection[m - 1] = static_cast<float>(k);
+        error *= 1.0 - k * k;
+    }
+    return static_cast<float>(error / correlation_[0]);
+}
+
+void FormantCorrector::stepUp(const float* reflection, float* taps) {
+    float a[kOrder + 1] = {1.0f};
+    for (size_t m = 1; m <= kOrder; ++m) {
+        const float k = reflection[m - 1];
+        // a_i += k a_{m-i} pairs up symmetrically, so no copy is needed
+        for (size_t i = 1; 2 * i <= m; ++i) {
+            float low = a[i];
+            float high = a[m - i];
+            a[i] = low + k * high;
+            if (2 * i != m) {
+                a[m - i] = high + k * low;
+            }
+        }
+        a[m] = k;
+    }
+    
+    // a_i multiplies the sample i before the newest, which is the last tap
+    std::fill(taps, taps + kTaps, 0.0f);
+    for (size_t i = 0; i <= kOrder; ++i) {
+        taps[kTaps - 1 - i] = a[i];
+    }
+}
+
+// Re-estimates both envelopes at a hop boundary and lays out the glide to
+// them over the next hop. The input window is taken latency samples back so
+// it describes the same moment as the output just analyzed.
+void FormantCorrector::updateEnvelopes(size_t latency) {
+    std::copy(whitenTo_.begin(), whitenTo_.end(), whitenFrom_.begin());
+    std::copy(colorTo_.begin(), colorTo_.end(), colorFrom_.begin());
+    gainFrom_ = gainTo_;
+    
+    size_t delay = std::min(inputAhead_ + latency, maxDelay_);
+    float inputResidual = analyze(inputHistory_, (inputWrite_ - delay) & historyMask_, colorTo_.data());
+    float outputResidual = analyze(outputHistory_, outputWrite_, whitenTo_.data());
+    
+    // Whitening leaves the output's residual power and recoloring scales it
+    // by the input's inverse; this restores the output's own level
+    gainTo_ = std::sqrt(inputResidual / std::max(outputResidual, 1e-6f));
+    gainTo_ = std::max(kMinGain, std::min(kMaxGain, gainTo_));
+    
+    // Interpolating reflection coefficients keeps every step stable
+    size_t numSteps = gainTable_.size();
+    for (size_t step = 0; step < numSteps; ++step) {
+        float fraction = (step + 1.0f) / numSteps;
+        for (size_t m = 0; m < kOrder; ++m) {
+            reflection_[m] = whitenFrom_[m] + fraction * (whitenTo_[m] - whitenFrom_[m]);
+        }
+        stepUp(reflection_.data(), whitenTable_.data() + step * kTaps);
+        for (size_t m = 0; m < kOrder; ++m) {
+            reflection_[m] = colorFrom_[m] + fraction * (colorTo_[m] - colorFrom_[m]);
+        }
+        stepUp(reflection_.data(), colorTable_.data() + step * kTaps);
+        gainTable_[step] = gainFrom_ + fraction * (gainTo_ - gainFrom_);
+    }
+}
+
+// e = A_out(z) x as an FIR, then y = g e - (A_in(z) - 1) y as an IIR, both in
+// direct form with taps from the current ramp step
+void FormantCorrector::filter(float* samples, size_t stride, size_t numFrames, size_t channel) {
+    const size_t history = kTaps - 1;
+    float* inputState = inputState_.data() + channel * history;
+    float* outputState = outputState_.data() + channel * history;
+    float* input = inputTaps_.data();
+    float* output = outputTaps_.data();
+    std::copy(inputState, inputState + history, input);
+    std::copy(outputState, outputState + history, output);
+    for (size_t i = 0; i < numFrames; ++i) {
+        input[history + i] = samples[i * stride];
+    }
+    
+    for (size_t i = 0; i < numFrames; ++i) {
+        size_t step = (sinceUpdate_ + i) / kRampLength;
+        const float* whiten = whitenTable_.data() + step * kTaps;
+        const float* color = colorTable_.data() + step * kTaps;
+        
+        float residual = dotProduct(input + i, whiten, kTaps);
+        output[history + i] = 0.0f;  // a_0 tap; the feedback sum covers past outputs only
+        float y = residual * gainTable_[step] - dotProduct(output + i, color, kTaps);
+        output[history + i] = y;
+        samples[i * stride] = y;
+    }
+    
+    std::copy(input + numFrames, input + numFrames + history, inputState);
+    std::copy(output + numFrames, output + numFrames + history, outputState);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include <cstddef>
+
+// Formant preservation for a pitch-shifted signal. Resampling grains moves
+// the spectral envelope along with the pitch; this stage whitens the shifted
+// output with its own LPC envelope and recolors it with the envelope of the
+// input, so vowels keep their formants at the new pitch.
+//
+// Envelopes are estimated once per hop (half an analysis window, lower than
+// typical block rates) from mono downmixes and shared by every channel and
+// every grain in that hop. Between hops the reflection coefficients glide in
+// kRampLength steps, each converted once to direct-form taps, so updates
+// don't click and the recoloring filter stays stable. Per sample that leaves
+// two short dot products per channel; per hop, two order-kOrder
+// autocorrelations and the tap tables.
+class FormantCorrector {
+public:
+    static constexpr size_t kOrder = 20;
+    // a_0..a_kOrder, padded to whole eight-lane groups
+    static constexpr size_t kTaps = (kOrder + 1 + 7) & ~static_cast<size_t>(7);
+    // Samples per coefficient step while gliding between envelopes
+    static constexpr size_t kRampLength = 32;
+    
+    // maxLatency bounds the delay passed to process*; maxBlockSize bounds the
+    // frames pushed ahead of each process* call
+    FormantCorrector(float sampleRate, size_t numChannels, size_t maxBlockSize, size_t maxLatency);
+    
+    // Records the unshifted input; call before the engine overwrites it
+    void pushInput(const float* input, size_t numFrames);
+    void pushInputPlanar(const float* const* inputs, size_t numFrames);
+    
+    // Corrects the engine's output in place. latency is the engine's wet
+    // delay, so the input envelope is taken from the matching moment.
+    void process(float* output, size_t numFrames, size_t latency);
+    void processPlanar(float* const* outputs, size_t numFrames, size_t latency);
+    
+    size_t getHopSize() const { return hopSize_; }
+    
+private:
+    // Fills reflection and returns the residual gain (error power over signal
+    // power); a flat envelope for silent windows
+    float analyze(const AlignedBuffer& history, size_t end, float* reflection);
+    // Direct-form taps of A(z), oldest first, from reflection coefficients
+    void stepUp(const float* reflection, float* taps);
+    void updateEnvelopes(size_t latency);
+    void filter(float* samples, size_t stride, size_t numFrames, size_t channel);
+    
+    size_t numChannels_;
+    size_t windowSize_;
+    size_t hopSize_;
+    size_t sinceUpdate_;
+    
+    // Mono downmixes, power-of-two rings
+    AlignedBuffer inputHistory_;
+    AlignedBuffer outputHistory_;
+    size_t historyMask_;
+    size_t inputWrite_;
+    size_t outputWrite_;
+    size_t inputAhead_;  // Input frames pushed but not yet matched by output
+    size_t maxDelay_;
+    
+    AlignedBuffer window_;
+    AlignedBuffer frame_;
+    AlignedArray<double> correlation_;
+    AlignedArray<double> lagWindow_;
+    AlignedArray<double> predictor_;
+    AlignedArray<double> previous_;
+    
+    // Envelopes as reflection coefficients, gliding from *From_ to *To_ over
+    // the current hop; the tables hold kTaps per ramp step
+    AlignedBuffer whitenFrom_;
+    AlignedBuffer whitenTo_;
+    AlignedBuffer colorFrom_;
+    AlignedBuffer colorTo_;
+    AlignedBuffer reflection_;
+    float gainFrom_;
+    float gainTo_;
+    AlignedBuffer whitenTable_;
+    AlignedBuffer colorTable_;
+    AlignedBuffer gainTable_;
+    
+    // Last kTaps - 1 filter inputs and outputs per channel, and scratch with
+    // that history followed by the current span
+    AlignedBuffer inputState_;
+    AlignedBuffer outputState_;
+    AlignedBuffer inputTaps_;
+    AlignedBuffer outputTaps_;
+};
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class Parameter {
+    PitchRatio,
+    Mix,
+    Gain,
+    Count
+};
+
+// Lock-free hand-off of parameter values from control threads to the audio
+// thread. Writers store the latest value and bump a version; the audio thread
+// polls once per block and only sees values that changed since its last
+// fetch. No locks, no allocation; the newest value wins.
+class ParameterMailbox {
+public:
+    ParameterMailbox() {
+        for (size_t i = 0; i < kCount; ++i) {
+            values_[i].store(0.0f, std::memory_order_relaxed);
+            versions_[i].store(0, std::memory_order_relaxed);
+            seen_[i] = 0;
+        }
+    }
+    
+    // Control threads
+    void post(Parameter parameter, float value) {
+        size_t index = static_cast<size_t>(parameter);
+        values_[index].store(value, std::memory_order_relaxed);
+        versions_[index].fetch_add(1, std::memory_order_release);
+    }
+    
+    // Audio thread: returns true and the latest value if it changed
+    bool fetch(Parameter parameter, float& value) {
+        size_t index = static_cast<size_t>(parameter);
+        uint32_t version = versions_[index].load(std::memory_order_acquire);
+        if (version == seen_[index]) return false;
+        seen_[index] = version;
+        value = values_[index].load(std::memory_order_relaxed);
+        return true;
+    }
+    
+private:
+    static constexpr size_t kCount = static_cast<size_t>(Parameter::Count);
+    static_assert(std::atomic<float>::is_always_lock_free, "float parameters must be lock-free");
+    
+    std::atomic<float> values_[kCount];
+    std::atomic<uint32_t> versions_[kCount];
+    uint32_t seen_[kCount];  // Audio thread only
+};
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "PcmPipe.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <unistd.h>
+
+namespace {
+
+// Reads until count bytes arrive or the input ends; -1 on error
+ssize_t readFully(int fd, uint8_t* data, size_t count) {
+    size_t done = 0;
+    while (done < count) {
+        ssize_t n = ::read(fd, data + done, count - done);
+        if (n == 0) break;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(done);
+}
+
+bool writeFully(int fd, const uint8_t* data, size_t count) {
+    while (count > 0) {
+        ssize_t n = ::write(fd, data, count);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        count -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void decode(const uint8_t* src, float* dst, size_t numSamples, PcmFormat format) {
+    if (format == PcmFormat::Int16) {
+        for (size_t i = 0; i < numSamples; ++i, src += 2) {
+            int16_t value = static_cast<int16_t>(src[0] | (src[1] << 8));
+            dst[i] = value / 32768.0f;
+        }
+    } else {
+        for (size_t i = 0; i < numSamples; ++i, src += 4) {
+            uint32_t bits = static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+                            (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+            std::memcpy(&dst[i], &bits, sizeof(float));
+        }
+    }
+}
+
+void encode(const float* src, uint8_t* dst, size_t numSamples, PcmFormat format) {
+    if (format == PcmFormat::Int16) {
+        for (size_t i = 0; i < numSamples; ++i, dst += 2) {
+            float clamped = std::max(-1.0f, std::min(1.0f, src[i]));
+            int16_t value = static_cast<int16_t>(std::lrint(clamped * 32767.0f));
+            dst[0] = static_cast<uint8_t>(value);
+            dst[1] = static_cast<uint8_t>(static_cast<uint16_t>(value) >> 8);
+        }
+    } else {
+        for (size_t i = 0; i < numSamples; ++i, dst += 4) {
+            uint32_t bits;
+            std::memcpy(&bits, &src[i], sizeof(float));
+            dst[0] = static_cast<uint8_t>(bits);
+            dst[1] = static_cast<uint8_t>(bits >> 8);
+            dst[2] = static_cast<uint8_t>(bits >> 16);
+            dst[3] = static_cast<uint8_t>(bits >> 24);
+        }
+    }
+}
+
+} // namespace
+
+bool parsePcmFormat(const char* name, PcmFormat& format) {
+    if (std::strcmp(name, "f32") == 0) {
+        format = PcmFormat::Float32;
+    } else if (std::strcmp(name, "s16") == 0) {
+        format = PcmFormat::Int16;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+PcmPipe::PcmPipe(int inputFd, int outputFd, PcmFormat format, size_t numChannels, size_t blockFrames,
+                 size_t numBlocks)
+    : inputFd_(inputFd)
+    , outputFd_(outputFd)
+    , format_(format)
+    , numChannels_(std::max<size_t>(1, numChannels))
+    , blockFrames_(std::max<size_t>(1, blockFrames))
+    , bytesPerSample_(format == PcmFormat::Int16 ? 2 : 4)
+    , filled_(0)
+    , processed_(0)
+    , written_(0)
+    , inputDone_(false)
+    , finishing_(false)
+    , failed_(false)
+    , bytesRead_(0)
+    , bytesWritten_(0) {
+    for (size_t i = 0; i < std::max<size_t>(2, numBlocks); ++i) {
+        auto block = std::make_unique<Block>();
+        block->samples.resize(blockFrames_ * numChannels_);
+        block->frames = 0;
+        blocks_.push_back(std::move(block));
+    }
+}
+
+PcmPipe::~PcmPipe() {
+    finish();
+}
+
+void PcmPipe::start() {
+    reader_ = std::thread(&PcmPipe::readLoop, this);
+    writer_ = std::thread(&PcmPipe::writeLoop, this);
+}
+
+void PcmPipe::fail(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!failed_) {
+        failed_ = true;
+        error_ = message;
+    }
+    changed_.notify_all();
+}
+
+size_t PcmPipe::acquire(float*& data) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [&] { return failed_ || processed_ < filled_ || inputDone_; });
+    if (failed_ || processed_ == filled_) return 0;
+    
+    Block& block = *blocks_[processed_ % blocks_.size()];
+    data = block.samples.data();
+    return block.frames;
+}
+
+void PcmPipe::release() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++processed_;
+    changed_.notify_all();
+}
+
+bool PcmPipe::finish() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        finishing_ = true;
+        changed_.notify_all();
+    }
+    // A reader blocked in read() only returns once the upstream writes or
+    // closes its end
+    if (reader_.joinable()) reader_.join();
+    if (writer_.joinable()) writer_.join();
+    return !failed_;
+}
+
+void PcmPipe::readLoop() {
+    const size_t frameBytes = bytesPerSample_ * numChannels_;
+    std::vector<uint8_t> raw(blockFrames_ * frameBytes);
+    
+    for (size_t index = 0;; ++index) {
+        {
+            // Wait for the writer to free the slot this block reuses
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&] { return failed_ || finishing_ || index - written_ < blocks_.size(); });
+            if (failed_ || finishing_) return;
+        }
+        
+        ssize_t bytes = readFully(inputFd_, raw.data(), raw.size());
+        if (bytes < 0) {
+            fail(std::string("Read failed: ") + std::strerror(errno));
+            return;
+        }
+        bytesRead_ += static_cast<uint64_t>(bytes);
+        
+        // A trailing partial frame can't be processed and is dropped
+        Block& block = *blocks_[index % blocks_.size()];
+        block.frames = static_cast<size_t>(bytes) / frameBytes;
+        decode(raw.data(), block.samples.data(), block.frames * numChannels_, format_);
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (block.frames > 0) {
+            ++filled_;
+        }
+        if (block.frames < blockFrames_) {
+            inputDone_ = true;
+        }
+        changed_.notify_all();
+        if (inputDone_) return;
+    }
+}
+
+void PcmPipe::writeLoop() {
+    const size_t frameBytes = bytesPerSample_ * numChannels_;
+    std::vector<uint8_t> raw(blockFrames_ * frameBytes);
+    
+    for (;;) {
+        size_t frames;
+        const float* samples;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&] { return failed_ || written_ < processed_ || finishing_; });
+            if (failed_ || written_ == processed_) return;
+            const Block& block = *blocks_[written_ % blocks_.size()];
+            frames = block.frames;
+            samples = block.samples.data();
+        }
+        
+        encode(samples, raw.data(), frames * numChannels_, format_);
+        if (!writeFully(outputFd_, raw.data(), frames * frameBytes)) {
+            fail(errno == EPIPE ? std::string("Output closed before the stream ended")
+                                : std::string("Write failed: ") + std::strerror(errno));
+            return;
+        }
+        bytesWritten_ += frames * frameBytes;
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++written_;
+        changed_.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Little-endian raw PCM sample formats, as ffmpeg's f32le / s16le and sox's
+// -t raw -e floating-point / -e signed-integer
+enum class PcmFormat {
+    Float32,
+    Int16
+};
+
+// Accepts "f32" or "s16"
+bool parsePcmFormat(const char* name, PcmFormat& format);
+
+// Streams raw interleaved PCM between two file descriptors through the
+// calling thread. A reader thread reads and decodes ahead into a small ring
+// of float blocks while a writer thread encodes and writes finished blocks,
+// so I/O, format conversion and DSP overlap. Reads and writes are whole
+// blocks (large syscalls); blocks are handed back and forth in order.
+class PcmPipe {
+public:
+    PcmPipe(int inputFd, int outputFd, PcmFormat format, size_t numChannels, size_t blockFrames,
+            size_t numBlocks = 4);
+    ~PcmPipe();
+    
+    PcmPipe(const PcmPipe&) = delete;
+    PcmPipe& operator=(const PcmPipe&) = delete;
+    
+    void start();
+    
+    // Waits for the next decoded block and returns its frame count, 0 at the
+    // end of input or after an error. Only the final block can be short.
+    size_t acquire(float*& data);
+    // Queues the block from the last acquire() for writing, processed in place
+    void release();
+    // Flushes queued blocks and joins both threads; false after an I/O error
+    bool finish();
+    
+    const std::string& getError() const { return error_; }
+    uint64_t getBytesRead() const { return bytesRead_; }
+    uint64_t getBytesWritten() const { return bytesWritten_; }
+    
+private:
+    struct Block {
+        AlignedBuffer samples;
+        size_t frames;
+    };
+    
+    void readLoop();
+    void writeLoop();
+    void fail(const std::string& message);
+    
+    int inputFd_;
+    int outputFd_;
+    PcmFormat format_;
+    size_t numChannels_;
+    size_t blockFrames_;
+    size_t bytesPerSample_;
+    std::vector<std::unique_ptr<Block>> blocks_;
+    
+    // Monotonic block counters: the reader fills, the caller processes and
+    // the writer drains, each in order around blocks_
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    size_t filled_;
+    size_t processed_;
+    size_t written_;
+    bool inputDone_;
+    bool finishing_;  // The caller has stopped acquiring
+    bool failed_;
+    std::string error_;
+    
+    std::thread reader_;
+    std::thread writer_;
+    uint64_t bytesRead_;     // Reader thread until joined
+    uint64_t bytesWritten_;  // Writer thread until joined
+};
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include "PhaseVocoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+const size_t kMinFrameSize = 256;
+const size_t kMaxFrameSize = 16384;
+// Peaks quieter than this relative to the frame maximum are treated as noise
+const float kPeakThreshold = 1e-4f;
+const float kTwoPi = 6.28318530717958647692f;
+
+size_t nearestPowerOfTwo(float value) {
+    size_t size = kMinFrameSize;
+    while (size < kMaxFrameSize && size * 1.5f < value) {
+        size *= 2;
+    }
+    return size;
+}
+
+float wrapPhase(float phase) {
+    return phase - kTwoPi * std::nearbyint(phase / kTwoPi);
+}
+}
+
+PhaseVocoder::PhaseVocoder(size_t bufferSize, float sampleRate, size_t numChannels, float frameMs)
+    : PitchEngine(bufferSize, numChannels)
+    , sampleRate_(sampleRate)
+    , frameSize_(nearestPowerOfTwo(frameMs * sampleRate / 1000.0f))
+    , hopSize_(frameSize_ / kOverlap)
+    , numBins_(frameSize_ / 2 + 1)
+    , pitchRatio_(1.0f)
+    , mixLevel_(1.0f)  // Default to 100% wet
+    , started_(false)
+    , fft_(frameSize_)
+    , fifoPosition_(frameSize_ - hopSize_)
+    , dryDelay_(0)
+    , numPeaks_(0) {
+    
+    mixLevel_.setRampLength(static_cast<size_t>(kSmoothingMs * sampleRate_ / 1000.0f));
+    
+    // Periodic Hann for both analysis and synthesis; the squared window sums
+    // to 3/8 * kOverlap across overlapping frames
+    window_.resize(frameSize_);
+    for (size_t i = 0; i < frameSize_; ++i) {
+        window_[i] = 0.5f * (1.0f - std::cos(kTwoPi * i / frameSize_));
+    }
+    outputScale_ = 1.0f / (0.375f * kOverlap);
+    
+    lanes_ = makeArenaArray<Lane>(numChannels_);
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        Lane& lane = lanes_[ch];
+        lane.inputFifo.resize(frameSize_);
+        lane.outputFifo.resize(hopSize_);
+        lane.outputAccum.resize(frameSize_);
+        lane.analysisPhase.assign(numBins_, 0.0f);
+        lane.synthesisPhase.assign(numBins_, 0.0f);
+        lane.dryDelay = makeArenaObject<RingBuffer>(frameSize_ + bufferSize_ + 1);
+    }
+    
+    frame_.resize(frameSize_);
+    spectrum_.resize(numBins_);
+    magnitude_.resize(numBins_);
+    phase_.resize(numBins_);
+    binFrequency_.resize(numBins_);
+    synthMagnitude_.resize(numBins_);
+    synthPhase_.resize(numBins_);
+    synthContribution_.resize(numBins_);
+    peaks_.resize(numBins_);
+    mixRamp_.resize(bufferSize_);
+    dry_.resize(bufferSize_);
+    dryFrom_.resize(bufferSize_);
+}
+
+PhaseVocoder::~PhaseVocoder() = default;
+
+void PhaseVocoder::setPitchRatio(float ratio) {
+    // Same ±1 octave range as the granular engine
+    pitchRatio_ = std::max(0.5f, std::min(2.0f, ratio));
+}
+
+void PhaseVocoder::setMixLevel(float mix) {
+    mix = std::max(0.0f, std::min(1.0f, mix));
+    if (started_) {
+        mixLevel_.setTarget(mix);
+    } else {
+        mixLevel_.snap(mix);
+    }
+}
+
+void PhaseVocoder::processChunk(const float* const* inputs, float* const* outputs, size_t numSamples) {
+    if (numSamples == 0) return;
+    const bool firstChunk = !started_;
+    started_ = true;
+    
+    const bool mixRamping = mixLevel_.isRamping();
+    if (mixRamping) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            mixRamp_[i] = mixLevel_.next();
+        }
+    }
+    const float dryGain = 1.0f - mixLevel_.getCurrent();
+    const float wetGain = mixLevel_.getCurrent();
+    const size_t latency = frameSize_ - hopSize_;
+    
+    // Compensation delays the dry path by the full frame latency; toggling it
+    // mid-stream cross-fades between the two taps over this chunk
+    const size_t targetDryDelay = compensateDry_ ? frameSize_ : 0;
+    const size_t previousDryDelay = firstChunk ? targetDryDelay : dryDelay_;
+    dryDelay_ = targetDryDelay;
+    const bool dryFading = previousDryDelay != dryDelay_;
+    const float fadeStep = 1.0f / static_cast<float>(numSamples);
+    
+    // Run up to each frame boundary, then analyse and resynthesize every lane
+    size_t offset = 0;
+    while (offset < numSamples) {
+        size_t span = std::min(numSamples - offset, frameSize_ - fifoPosition_);
+        
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            Lane& lane = lanes_[ch];
+            float* fifoIn = lane.inputFifo.data() + fifoPosition_;
+            const float* fifoOut = lane.outputFifo.data() + (fifoPosition_ - latency);
+            float* output = outputs[ch] + offset;
+            
+            // Copy the input first so the dry path survives in-place processing
+            std::memcpy(fifoIn, inputs[ch] + offset, span * sizeof(float));
+            lane.dryDelay->write(fifoIn, span);
+            
+            const float* dry = fifoIn;
+            if (dryFading) {
+                float* dryFrom = dryFrom_.data();
+                lane.dryDelay->peekBlock(previousDryDelay, dryFrom, span);
+                lane.dryDelay->peekBlock(dryDelay_, dry_.data(), span);
+                for (size_t i = 0; i < span; ++i) {
+                    float fade = (offset + i + 1) * fadeStep;
+                    dry_[i] = dryFrom[i] + fade * (dry_[i] - dryFrom[i]);
+                }
+                dry = dry_.data();
+            } else if (dryDelay_ > 0) {
+                lane.dryDelay->peekBlock(dryDelay_, dry_.data(), span);
+                dry = dry_.data();
+            }
+            
+            if (mixRamping) {
+                const float* mix = mixRamp_.data() + offset;
+                for (size_t i = 0; i < span; ++i) {
+                    output[i] = (1.0f - mix[i]) * dry[i] + mix[i] * fifoOut[i];
+                }
+            } else {
+                for (size_t i = 0; i < span; ++i) {
+                    output[i] = dryGain * dry[i] + wetGain * fifoOut[i];
+                }
+            }
+        }
+        
+        fifoPosition_ += span;
+        offset += span;
+        
+        if (fifoPosition_ == frameSize_) {
+            fifoPosition_ = latency;
+            for (size_t ch = 0; ch < numChannels_; ++ch) {
+                processFrame(lanes_[ch]);
+            }
+        }
+    }
+}
+
+void PhaseVocoder::findPeaks() {
+    numPeaks_ = 0;
+    float maxMagnitude = *std::max_element(magnitude_.begin(), magnitude_.end());
+    float threshold = maxMagnitude * kPeakThreshold;
+    
+    // A peak is no smaller than its two neighbours on each side. Plateaus
+    // count, so flat spectra such as impulses keep every bin rather than none.
+    for (size_t k = 2; k + 2 < numBins_; ++k) {
+        float m = magnitude_[k];
+        if (m > threshold && m >= magnitude_[k - 1] && m >= magnitude_[k - 2] &&
+            m >= magnitude_[k + 1] && m >= magnitude_[k + 2]) {
+            peaks_[numPeaks_++] = k;
+        }
+    }
+}
+
+void PhaseVocoder::processFrame(Lane& lane) {
+    const float expectedAdvance = kTwoPi * hopSize_ / frameSize_;  // Per bin per hop
+    const float ratio = pitchRatio_;
+    
+    for (size_t i = 0; i < frameSize_; ++i) {
+        frame_[i] = lane.inputFifo[i] * window_[i];
+    }
+    fft_.forward(frame_.data(), spectrum_.data());
+    
+    // Deviation of each bin's phase advance from its centre frequency gives
+    // the true frequency of the partial it holds
+    for (size_t k = 0; k < numBins_; ++k) {
+        float phase = std::arg(spectrum_[k]);
+        float deviation = wrapPhase(phase - lane.analysisPhase[k] - k * expectedAdvance);
+        lane.analysisPhase[k] = phase;
+        magnitude_[k] = std::abs(spectrum_[k]);
+        phase_[k] = phase;
+        binFrequency_[k] = k + deviation / expectedAdvance;
+    }
+    
+    findPeaks();
+    std::fill(synthMagnitude_.begin(), synthMagnitude_.end(), 0.0f);
+    std::fill(synthContribution_.begin(), synthContribution_.end(), 0.0f);
+    
+    // Bins where no region lands keep advancing at their centre frequency so
+    // a partial moving in later starts from a continuous phase
+    for (size_t k = 0; k < numBins_; ++k) {
+        synthPhase_[k] = wrapPhase(lane.synthesisPhase[k] + k * expectedAdvance);
+    }
+    
+    for (size_t p = 0; p < numPeaks_; ++p) {
+        size_t peak = peaks_[p];
+        long target = std::lround(peak * ratio);
+        if (target <= 0 || target >= static_cast<long>(numBins_)) continue;  // Above Nyquist
+        
+        // The region of influence runs to the magnitude minimum between
+        // neighbouring peaks
+        size_t lo = 0;
+        size_t hi = numBins_ - 1;
+        if (p > 0) {
+            lo = std::min_element(magnitude_.begin() + peaks_[p - 1], magnitude_.begin() + peak) -
+                 magnitude_.begin() + 1;
+        }
+        if (p + 1 < numPeaks_) {
+            hi = std::min_element(magnitude_.begin() + peak, magnitude_.begin() + peaks_[p + 1]) -
+                 magnitude_.begin();
+        }
+        
+        long shift = target - static_cast<long>(peak);
+        float peakPhase = lane.synthesisPhase[target] + binFrequency_[peak] * ratio * expectedAdvance;
+        
+        for (size_t k = lo; k <= hi; ++k) {
+            long dest = static_cast<long>(k) + shift;
+            if (dest < 0 || dest >= static_cast<long>(numBins_)) continue;
+            // Regions can overlap when shifting down; the loudest source sets
+            // the phase while magnitudes accumulate
+            synthMagnitude_[dest] += magnitude_[k];
+            if (magnitude_[k] > synthContribution_[dest]) {
+                synthContribution_[dest] = magnitude_[k];
+                synthPhase_[dest] = wrapPhase(peakPhase + phase_[k] - phase_[peak]);
+            }
+        }
+    }
+    
+    for (size_t k = 0; k < numBins_; ++k) {
+        lane.synthesisPhase[k] = synthPhase_[k];
+        spectrum_[k] = std::polar(synthMagnitude_[k], synthPhase_[k]);
+    }
+    fft_.inverse(spectrum_.data(), frame_.data());
+    
+    float* accum = lane.outputAccum.data();
+    for (size_t i = 0; i < frameSize_; ++i) {
+        accum[i] += frame_[i] * window_[i] * outputScale_;
+    }
+    
+    // The first hop is complete; shift both frames along by one hop
+    std::memcpy(lane.outputFifo.data(), accum, hopSize_ * sizeof(float));
+    std::memmove(accum, accum + hopSize_, (frameSize_ - hopSize_) * sizeof(float));
+    std::fill(accum + frameSize_ - hopSize_, accum + frameSize_, 0.0f);
+    std::memmove(lane.inputFifo.data(), lane.inputFifo.data() + hopSize_,
+                 (frameSize_ - hopSize_) * sizeof(float));
+}
\ No newline at end of file
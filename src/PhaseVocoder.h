@@ -0,0 +1,86 @@
+#pragma once
+#include "PitchEngine.h"
+#include "AlignedBuffer.h"
+#include "SmoothedValue.h"
+#include "FFT.h"
+#include "RingBuffer.h"
+#include <complex>
+
+// STFT phase vocoder pitch shifter. Each analysis frame is searched for
+// spectral peaks; every peak's true frequency is estimated from its phase
+// advance, the peak is moved to its shifted bin and the bins in its region of
+// influence follow it rigidly, keeping their phases locked to the peak
+// (Laroche-Dolson identity phase locking). Unlike the granular engine there
+// are no grain seams, at the cost of a fixed latency of one frame.
+//
+// Frame timing is shared across lanes, so channels stay time-aligned.
+class PhaseVocoder : public PitchEngine {
+public:
+    // Rounded to the nearest power of two: 2048 samples at 44.1 kHz
+    static constexpr float kDefaultFrameMs = 46.4f;
+    static constexpr size_t kOverlap = 4;
+    static constexpr float kSmoothingMs = 20.0f;
+    
+    PhaseVocoder(size_t bufferSize, float sampleRate, size_t numChannels = 1,
+                 float frameMs = kDefaultFrameMs);
+    ~PhaseVocoder() override;
+    
+    // The ratio is picked up at the next frame boundary; mix ramps per sample
+    void setPitchRatio(float ratio) override;
+    void setMixLevel(float mix) override;  // 0.0 = dry, 1.0 = wet
+    
+    // A sample is final once the last frame overlapping it is synthesized,
+    // which is a full frame after it entered
+    size_t getLatencySamples() const override { return frameSize_; }
+    size_t getMaxLatencySamples() const override { return frameSize_; }
+    
+    size_t getFrameSize() const { return frameSize_; }
+    size_t getHopSize() const { return hopSize_; }
+    
+protected:
+    void processChunk(const float* const* inputs, float* const* outputs, size_t numSamples) override;
+    
+private:
+    struct Lane {
+        AlignedBuffer inputFifo;     // Last frameSize_ input samples
+        AlignedBuffer outputFifo;    // Finished output for the current hop
+        AlignedBuffer outputAccum;   // Overlap-add accumulator, one frame long
+        AlignedBuffer analysisPhase;   // Previous frame's phase per bin
+        AlignedBuffer synthesisPhase;  // Previous output phase per bin
+        ArenaPtr<RingBuffer> dryDelay;  // Input history for the compensated dry path
+    };
+    
+    void processFrame(Lane& lane);
+    void findPeaks();
+    
+    float sampleRate_;
+    size_t frameSize_;
+    size_t hopSize_;
+    size_t numBins_;
+    float outputScale_;  // Undoes the analysis x synthesis window overlap gain
+    
+    float pitchRatio_;
+    SmoothedValue mixLevel_;
+    bool started_;
+    
+    RealFFTPlan fft_;
+    AlignedBuffer window_;
+    ArenaPtr<Lane[]> lanes_;  // One per channel
+    size_t fifoPosition_;  // Write position in every lane's inputFifo
+    size_t dryDelay_;      // 0 or frameSize_ with dry compensation
+    
+    // Per-frame scratch, reused lane by lane
+    AlignedBuffer frame_;
+    AlignedArray<std::complex<float>> spectrum_;
+    AlignedBuffer magnitude_;
+    AlignedBuffer phase_;
+    AlignedBuffer binFrequency_;   // True frequency in bins
+    AlignedBuffer synthMagnitude_;
+    AlignedBuffer synthPhase_;
+    AlignedBuffer synthContribution_;  // Loudest source bin so far
+    AlignedArray<size_t> peaks_;       // Bin indices, numPeaks_ in use
+    size_t numPeaks_;
+    AlignedBuffer mixRamp_;
+    AlignedBuffer dry_;
+    AlignedBuffer dryFrom_;
+};
\ No newline at end of file
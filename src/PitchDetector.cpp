@@ -0,0 +1,155 @@
+#include "PitchDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// YIN absolute threshold on the normalized difference
+const float kThreshold = 0.15f;
+// Above this aperiodicity the frame is treated as unvoiced
+const float kUnvoicedThreshold = 0.4f;
+// Frames quieter than this (mean square) are treated as silence
+const float kSilenceEnergy = 1e-7f;
+
+size_t nextPowerOfTwo(size_t value) {
+    size_t size = 1;
+    while (size < value) {
+        size *= 2;
+    }
+    return size;
+}
+}
+
+PitchDetector::PitchDetector(float sampleRate, float minFrequency, float maxFrequency, size_t hopSize)
+    : sampleRate_(sampleRate)
+    , minLag_(std::max<size_t>(2, static_cast<size_t>(sampleRate / maxFrequency)))
+    , maxLag_(std::max(minLag_ + 2, static_cast<size_t>(std::ceil(sampleRate / minFrequency))))
+    , windowSize_(maxLag_)
+    , historySize_(windowSize_ + maxLag_)
+    , hopSize_(std::max<size_t>(1, hopSize))
+    , historyMask_(nextPowerOfTwo(historySize_) - 1)
+    , writeIndex_(0)
+    , sinceAnalysis_(0)
+    , fft_(nextPowerOfTwo(historySize_))  // Linear, not circular, correlation up to maxLag_
+    , period_(0.0f)
+    , confidence_(0.0f) {
+    
+    history_.assign(historyMask_ + 1, 0.0f);
+    frame_.resize(historySize_);
+    padded_.assign(fft_.getSize(), 0.0f);
+    windowSpectrum_.resize(fft_.getNumBins());
+    frameSpectrum_.resize(fft_.getNumBins());
+    correlation_.resize(fft_.getSize());
+    energy_.resize(historySize_ + 1);
+    difference_.resize(maxLag_ + 2);
+}
+
+void PitchDetector::pushSamples(const float* samples, size_t numFrames, size_t numChannels) {
+    if (numChannels == 0) return;
+    const float scale = 1.0f / numChannels;
+    
+    for (size_t i = 0; i < numFrames; ++i) {
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            sum += samples[i * numChannels + ch];
+        }
+        push(sum * scale);
+    }
+}
+
+void PitchDetector::pushPlanar(const float* const* channels, size_t numFrames, size_t numChannels) {
+    if (numChannels == 0) return;
+    const float scale = 1.0f / numChannels;
+    
+    for (size_t i = 0; i < numFrames; ++i) {
+        float sum = 0.0f;
+        for (size_t ch = 0; ch < numChannels; ++ch) {
+            sum += channels[ch][i];
+        }
+        push(sum * scale);
+    }
+}
+
+void PitchDetector::push(float sample) {
+    history_[writeIndex_] = sample;
+    writeIndex_ = (writeIndex_ + 1) & historyMask_;
+    
+    if (++sinceAnalysis_ == hopSize_) {
+        sinceAnalysis_ = 0;
+        analyze();
+    }
+}
+
+void PitchDetector::analyze() {
+    // Unroll the newest historySize_ samples, oldest first
+    size_t start = (writeIndex_ - historySize_) & historyMask_;
+    energy_[0] = 0.0f;
+    for (size_t i = 0; i < historySize_; ++i) {
+        float x = history_[(start + i) & historyMask_];
+        frame_[i] = x;
+        energy_[i + 1] = energy_[i] + x * x;
+    }
+    
+    float windowEnergy = energy_[windowSize_];
+    if (windowEnergy < kSilenceEnergy * windowSize_) {
+        period_ = 0.0f;
+        confidence_ = 0.0f;
+        return;
+    }
+    
+    // r(tau) = sum_j x[j] x[j + tau] for j < W, as IFFT(conj(X_W) * X)
+    std::copy(frame_.begin(), frame_.begin() + windowSize_, padded_.begin());
+    std::fill(padded_.begin() + windowSize_, padded_.end(), 0.0f);
+    fft_.forward(padded_.data(), windowSpectrum_.data());
+    std::copy(frame_.begin(), frame_.end(), padded_.begin());
+    fft_.forward(padded_.data(), frameSpectrum_.data());
+    for (size_t k = 0; k < frameSpectrum_.size(); ++k) {
+        frameSpectrum_[k] *= std::conj(windowSpectrum_[k]);
+    }
+    fft_.inverse(frameSpectrum_.data(), correlation_.data());
+    
+    // d(tau) = e(0) + e(tau) - 2 r(tau), normalized by its cumulative mean
+    difference_[0] = 1.0f;
+    float runningSum = 0.0f;
+    for (size_t tau = 1; tau <= maxLag_; ++tau) {
+        float shiftedEnergy = energy_[tau + windowSize_] - energy_[tau];
+        float d = std::max(0.0f, windowEnergy + shiftedEnergy - 2.0f * correlation_[tau]);
+        runningSum += d;
+        difference_[tau] = runningSum > 0.0f ? d * tau / runningSum : 1.0f;
+    }
+    
+    // First dip under the threshold, followed down to its local minimum;
+    // otherwise the global minimum if it is periodic enough
+    size_t best = 0;
+    for (size_t tau = minLag_; tau < maxLag_; ++tau) {
+        if (difference_[tau] < kThreshold) {
+            while (tau + 1 < maxLag_ && difference_[tau + 1] < difference_[tau]) {
+                ++tau;
+            }
+            best = tau;
+            break;
+        }
+    }
+    if (best == 0) {
+        best = minLag_;
+        for (size_t tau = minLag_ + 1; tau < maxLag_; ++tau) {
+            if (difference_[tau] < difference_[best]) {
+                best = tau;
+            }
+        }
+        if (difference_[best] > kUnvoicedThreshold) {
+            period_ = 0.0f;
+            confidence_ = 1.0f - difference_[best];
+            return;
+        }
+    }
+    
+    // Parabolic interpolation for a sub-sample period
+    float prev = difference_[best - 1];
+    float curr = difference_[best];
+    float next = difference_[best + 1];
+    float denominator = prev - 2.0f * curr + next;
+    float offset = std::fabs(denominator) > 1e-12f ? 0.5f * (prev - next) / denominator : 0.0f;
+    
+    period_ = best + std::max(-0.5f, std::min(0.5f, offset));
+    confidence_ = 1.0f - curr;
+}
\ No newline at end of file
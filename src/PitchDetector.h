@@ -0,0 +1,53 @@
+#pragma once
+#include "FFT.h"
+#include "AlignedBuffer.h"
+#include <complex>
+
+// YIN fundamental-frequency tracker. Input is pushed block by block into a
+// history ring; analysis runs once per hop regardless of the host block size,
+// so the cost per callback stays flat at small buffers. The difference
+// function d(tau) is built from an FFT cross-correlation plus running energy
+// sums instead of the O(W * maxLag) direct loop.
+class PitchDetector {
+public:
+    PitchDetector(float sampleRate, float minFrequency = 60.0f, float maxFrequency = 1000.0f,
+                  size_t hopSize = 256);
+    
+    // Interleaved frames are downmixed to mono; never allocates
+    void pushSamples(const float* samples, size_t numFrames, size_t numChannels = 1);
+    // One pointer per channel, downmixed the same way
+    void pushPlanar(const float* const* channels, size_t numFrames, size_t numChannels);
+    
+    // Latest estimate; 0 when the input is unvoiced or silent
+    float getFrequency() const { return period_ > 0.0f ? sampleRate_ / period_ : 0.0f; }
+    float getPeriod() const { return period_; }  // In samples
+    float getConfidence() const { return confidence_; }  // 1 - YIN aperiodicity
+    
+private:
+    void push(float sample);
+    void analyze();
+    
+    float sampleRate_;
+    size_t minLag_;
+    size_t maxLag_;
+    size_t windowSize_;   // Integration window W, one longest period
+    size_t historySize_;  // W + maxLag_ samples are compared per analysis
+    size_t hopSize_;
+    
+    AlignedBuffer history_;  // Power-of-two ring
+    size_t historyMask_;
+    size_t writeIndex_;
+    size_t sinceAnalysis_;
+    
+    RealFFTPlan fft_;
+    AlignedBuffer frame_;     // Unrolled history, oldest first
+    AlignedBuffer padded_;
+    AlignedArray<std::complex<float>> windowSpectrum_;
+    AlignedArray<std::complex<float>> frameSpectrum_;
+    AlignedBuffer correlation_;
+    AlignedBuffer energy_;      // Prefix sums of squares over frame_
+    AlignedBuffer difference_;  // Cumulative-mean-normalized d(tau)
+    
+    float period_;
+    float confidence_;
+};
\ No newline at end of file
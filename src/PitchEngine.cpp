@@ -0,0 +1,86 @@
+#include "PitchEngine.h"
+#include "PitchShifter.h"
+#include "PhaseVocoder.h"
+#include <algorithm>
+
+PitchEngine::PitchEngine(size_t bufferSize, size_t numChannels)
+    : bufferSize_(bufferSize)
+    , numChannels_(std::max<size_t>(1, numChannels))
+    , compensateDry_(false)
+    , chunkPosition_(0) {
+    planarInput_.resize(bufferSize_ * numChannels_);
+    planarOutput_.resize(bufferSize_ * numChannels_);
+    inputPointers_.resize(numChannels_);
+    outputPointers_.resize(numChannels_);
+}
+
+PitchEngine::~PitchEngine() = default;
+
+void PitchEngine::processBlock(const float* input, float* output, size_t numSamples) {
+    processPlanar(&input, &output, numSamples);
+}
+
+// Engines size their internal buffers for bufferSize_ frames per chunk; a
+// chunk ends early where the current span does
+size_t PitchEngine::nextChunk(size_t remaining) {
+    size_t chunk = std::min(bufferSize_ - chunkPosition_, remaining);
+    chunkPosition_ = (chunkPosition_ + chunk) % bufferSize_;
+    return chunk;
+}
+
+void PitchEngine::processPlanar(const float* const* inputs, float* const* outputs, size_t numSamples) {
+    for (size_t offset = 0, chunk = 0; offset < numSamples; offset += chunk) {
+        chunk = nextChunk(numSamples - offset);
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            inputPointers_[ch] = inputs[ch] + offset;
+            outputPointers_[ch] = outputs[ch] + offset;
+        }
+        processChunk(inputPointers_.data(), outputPointers_.data(), chunk);
+    }
+}
+
+void PitchEngine::processInterleaved(const float* input, float* output, size_t numFrames) {
+    // Mono interleaved is already planar
+    if (numChannels_ == 1) {
+        processPlanar(&input, &output, numFrames);
+        return;
+    }
+    
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        inputPointers_[ch] = planarInput_.data() + ch * bufferSize_;
+        outputPointers_[ch] = planarOutput_.data() + ch * bufferSize_;
+    }
+    
+    for (size_t offset = 0, chunk = 0; offset < numFrames; offset += chunk) {
+        chunk = nextChunk(numFrames - offset);
+        const float* frameIn = input + offset * numChannels_;
+        float* frameOut = output + offset * numChannels_;
+        
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            float* lane = planarInput_.data() + ch * bufferSize_;
+            for (size_t i = 0; i < chunk; ++i) {
+                lane[i] = frameIn[i * numChannels_ + ch];
+            }
+        }
+        
+        processChunk(inputPointers_.data(), outputPointers_.data(), chunk);
+        
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            const float* lane = planarOutput_.data() + ch * bufferSize_;
+            for (size_t i = 0; i < chunk; ++i) {
+                frameOut[i * numChannels_ + ch] = lane[i];
+            }
+        }
+    }
+}
+
+ArenaPtr<PitchEngine> createPitchEngine(EngineType type, size_t bufferSize, float sampleRate,
+                                        size_t numChannels, float grainMs) {
+    switch (type) {
+        case EngineType::PhaseVocoder:
+            return makeArenaObject<PhaseVocoder>(bufferSize, sampleRate, numChannels);
+        case EngineType::Granular:
+        default:
+            return makeArenaObject<PitchShifter>(bufferSize, sampleRate, numChannels, grainMs);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include "ArenaPtr.h"
+#include <cstddef>
+
+enum class EngineType {
+    Granular,      // Two-grain delay-line shifter (PitchShifter)
+    PhaseVocoder   // STFT phase vocoder with peak phase locking
+};
+
+// Common interface for the pitch-shifting algorithms. Engines implement
+// processChunk for planar chunks of at most getBufferSize() frames; this base
+// class splits arbitrary host blocks into such chunks and adapts mono and
+// interleaved I/O onto them. Chunks are cut at multiples of getBufferSize()
+// counted from the start of the stream, so one never straddles that grid and
+// the sequence of chunk boundaries doesn't depend on the host block size.
+class PitchEngine {
+public:
+    PitchEngine(size_t bufferSize, size_t numChannels);
+    virtual ~PitchEngine();
+    
+    // Safe to call from the audio thread between blocks
+    virtual void setPitchRatio(float ratio) = 0;
+    virtual void setMixLevel(float mix) = 0;  // 0.0 = dry, 1.0 = wet
+    
+    // Input pitch period in samples from a pitch tracker, 0 when unvoiced.
+    // Engines that can align their processing to pitch periods use it.
+    virtual void setPitchPeriod(float /*samples*/) {}
+    
+    // Delay of the wet signal relative to the input at the current ratio
+    virtual size_t getLatencySamples() const = 0;
+    // Upper bound on getLatencySamples() over the whole ratio range, for
+    // sizing buffers that align other signals with the wet one
+    virtual size_t getMaxLatencySamples() const = 0;
+    
+    // Delays the dry signal by getLatencySamples() so partial mixes line up
+    // with the wet signal instead of comb filtering. Off by default, which
+    // leaves the dry path with no latency at all.
+    void setDryCompensation(bool enabled) { compensateDry_ = enabled; }
+    bool getDryCompensation() const { return compensateDry_; }
+    
+    // Mono convenience for single-channel engines
+    void processBlock(const float* input, float* output, size_t numSamples);
+    // One pointer per channel; input and output may alias
+    void processPlanar(const float* const* inputs, float* const* outputs, size_t numSamples);
+    // Interleaved frames of numChannels samples; input and output may alias
+    void processInterleaved(const float* input, float* output, size_t numFrames);
+    
+    size_t getNumChannels() const { return numChannels_; }
+    size_t getBufferSize() const { return bufferSize_; }
+    
+protected:
+    virtual void processChunk(const float* const* inputs, float* const* outputs, size_t numSamples) = 0;
+    
+    size_t bufferSize_;
+    size_t numChannels_;
+    bool compensateDry_;
+    
+private:
+    size_t nextChunk(size_t remaining);
+    
+    size_t chunkPosition_;  // Frames into the current bufferSize_ span
+    // Channel-blocked copies of interleaved I/O, bufferSize_ per channel
+    AlignedBuffer planarInput_;
+    AlignedBuffer planarOutput_;
+    AlignedArray<const float*> inputPointers_;
+    AlignedArray<float*> outputPointers_;
+};
+
+// grainMs sets the granular engine's grain length; the phase vocoder keeps
+// its own frame size
+ArenaPtr<PitchEngine> createPitchEngine(EngineType type, size_t bufferSize, float sampleRate,
+                                        size_t numChannels, float grainMs);
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "PitchProcessor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+float semitonesToRatio(float semitones) {
+    return std::pow(2.0f, semitones / 12.0f);
+}
+
+ArenaPtr<PitchEngine> createConfiguredEngine(const PitchProcessorConfig& config) {
+    ArenaPtr<PitchEngine> engine = createPitchEngine(config.engine, config.hopSize, config.sampleRate,
+                                                     config.numChannels, config.grainMs);
+    engine->setPitchRatio(semitonesToRatio(config.semitones));
+    engine->setMixLevel(config.mixLevel);
+    engine->setDryCompensation(config.compensateDry);
+    if (auto* granular = dynamic_cast<PitchShifter*>(engine.get())) {
+        granular->setWindowShape(config.windowShape);
+    }
+    return engine;
+}
+
+ArenaPtr<PitchDetector> createDetector(const PitchProcessorConfig& config) {
+    if (!config.trackPitch && !config.snapToScale) return nullptr;
+    return makeArenaObject<PitchDetector>(config.sampleRate);
+}
+
+ArenaPtr<FormantCorrector> createFormantCorrector(const PitchProcessorConfig& config,
+                                                  const PitchEngine& engine) {
+    if (!config.preserveFormants) return nullptr;
+    return makeArenaObject<FormantCorrector>(config.sampleRate, engine.getNumChannels(),
+                                             engine.getBufferSize(), engine.getMaxLatencySamples());
+}
+
+} // namespace
+
+PitchProcessor::PitchProcessor(const PitchProcessorConfig& config)
+    : arena_(measure(config))
+    , numChannels_(std::max<size_t>(1, config.numChannels))
+    , hopSize_(std::max<size_t>(1, config.hopSize))
+    , hopPosition_(0)
+    , snapToScale_(config.snapToScale)
+    , scale_(config.scale)
+    , pitchRatio_(semitonesToRatio(config.semitones)) {
+    Arena::Scope scope(&arena_);
+    engine_ = createConfiguredEngine(config);
+    detector_ = createDetector(config);
+    formants_ = createFormantCorrector(config, *engine_);
+    inputPointers_.resize(numChannels_);
+    outputPointers_.resize(numChannels_);
+    outputGain_.snap(config.outputGain);
+    outputGain_.setRampLength(static_cast<size_t>(PitchShifter::kSmoothingMs * config.sampleRate / 1000.0f));
+    latency_.store(engine_->getLatencySamples(), std::memory_order_relaxed);
+}
+
+PitchProcessor::~PitchProcessor() = default;
+
+// Dry run against an empty arena: every object and buffer overflows to the
+// heap and is tallied, giving the exact capacity this configuration needs
+size_t PitchProcessor::measure(const PitchProcessorConfig& config) {
+    Arena sizing(0);
+    Arena::Scope scope(&sizing);
+    ArenaPtr<PitchEngine> engine = createConfiguredEngine(config);
+    createDetector(config);
+    createFormantCorrector(config, *engine);
+    AlignedArray<const float*> inputPointers(engine->getNumChannels());
+    AlignedArray<float*> outputPointers(engine->getNumChannels());
+    return sizing.getOverflow() + config.hostArenaBytes;
+}
+
+void PitchProcessor::setSemitones(float semitones) {
+    parameters_.post(Parameter::PitchRatio, semitonesToRatio(semitones));
+}
+
+void PitchProcessor::setMixLevel(float mix) {
+    parameters_.post(Parameter::Mix, mix);
+}
+
+void PitchProcessor::setOutputGain(float gain) {
+    parameters_.post(Parameter::Gain, gain);
+}
+
+// Applies parameter changes and the tracker's estimate, then publishes the
+// resulting latency for other threads
+void PitchProcessor::beginHop() {
+    fetchParameters();
+    if (detector_) {
+        applyPitchTracking();
+    }
+    latency_.store(engine_->getLatencySamples(), std::memory_order_relaxed);
+}
+
+// Picks up changes posted since the last hop; the engine and gain ramp
+// towards them over the following samples
+void PitchProcessor::fetchParameters() {
+    float value;
+    if (parameters_.fetch(Parameter::PitchRatio, value)) {
+        pitchRatio_ = value;
+        engine_->setPitchRatio(value);
+    }
+    if (parameters_.fetch(Parameter::Mix, value)) {
+        engine_->setMixLevel(value);
+    }
+    if (parameters_.fetch(Parameter::Gain, value)) {
+        outputGain_.setTarget(value);
+    }
+}
+
+// Applies the tracker's estimate: grains align to the input period and, with
+// a scale, the ratio is adjusted so the shifted pitch lands on the nearest
+// scale note. The estimate covers the input up to the start of the hop.
+void PitchProcessor::applyPitchTracking() {
+    engine_->setPitchPeriod(detector_->getPeriod());
+    
+    float ratio = pitchRatio_;
+    float frequency = detector_->getFrequency();
+    if (snapToScale_ && frequency > 0.0f) {
+        ratio = scale_.snap(frequency * ratio) / frequency;
+    }
+    engine_->setPitchRatio(ratio);
+}
+
+// One piece of a hop. The tracker and the corrector record the chunk's input
+// before in-place processing overwrites it; the corrector never holds more
+// than one hop of input ahead of the output.
+void PitchProcessor::processChunkInterleaved(const float* input, float* output, size_t numFrames) {
+    if (detector_) {
+        detector_->pushSamples(input, numFrames, numChannels_);
+    }
+    if (formants_) {
+        formants_->pushInput(input, numFrames);
+        engine_->processInterleaved(input, output, numFrames);
+        formants_->process(output, numFrames, engine_->getLatencySamples());
+    } else {
+        engine_->processInterleaved(input, output, numFrames);
+    }
+    
+    if (outputGain_.isRamping()) {
+        for (size_t i = 0; i < numFrames; ++i) {
+            float gain = outputGain_.next();
+            for (size_t ch = 0; ch < numChannels_; ++ch) {
+                output[i * numChannels_ + ch] *= gain;
+            }
+        }
+    } else {
+        float gain = outputGain_.getCurrent();
+        size_t numSamples = numFrames * numChannels_;
+        for (size_t i = 0; i < numSamples; ++i) {
+            output[i] *= gain;
+        }
+    }
+}
+
+void PitchProcessor::processChunkPlanar(const float* const* inputs, float* const* outputs, size_t numFrames) {
+    if (detector_) {
+        detector_->pushPlanar(inputs, numFrames, numChannels_);
+    }
+    if (formants_) {
+        formants_->pushInputPlanar(inputs, numFrames);
+        engine_->processPlanar(inputs, outputs, numFrames);
+        formants_->processPlanar(outputs, numFrames, engine_->getLatencySamples());
+    } else {
+        engine_->processPlanar(inputs, outputs, numFrames);
+    }
+    
+    if (outputGain_.isRamping()) {
+        for (size_t i = 0; i < numFrames; ++i) {
+            float gain = outputGain_.next();
+            for (size_t ch = 0; ch < numChannels_; ++ch) {
+                outputs[ch][i] *= gain;
+            }
+        }
+    } else {
+        float gain = outputGain_.getCurrent();
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            for (size_t i = 0; i < numFrames; ++i) {
+                outputs[ch][i] *= gain;
+            }
+        }
+    }
+}
+
+// Splits the block where hops end, so chunks line up with the same hop grid
+// whatever the host block size, and updates state only where a hop starts
+void PitchProcessor::processInterleaved(const float* input, float* output, size_t numFrames) {
+    for (size_t offset = 0; offset < numFrames;) {
+        if (hopPosition_ == 0) {
+            beginHop();
+        }
+        size_t chunk = std::min(hopSize_ - hopPosition_, numFrames - offset);
+        size_t first = offset * numChannels_;
+        processChunkInterleaved(input + first, output + first, chunk);
+        offset += chunk;
+        hopPosition_ = (hopPosition_ + chunk) % hopSize_;
+    }
+}
+
+void PitchProcessor::processPlanar(const float* const* inputs, float* const* outputs, size_t numFrames) {
+    for (size_t offset = 0; offset < numFrames;) {
+        if (hopPosition_ == 0) {
+            beginHop();
+        }
+        size_t chunk = std::min(hopSize_ - hopPosition_, numFrames - offset);
+        for (size_t ch = 0; ch < numChannels_; ++ch) {
+            inputPointers_[ch] = inputs[ch] + offset;
+            outputPointers_[ch] = outputs[ch] + offset;
+        }
+        processChunkPlanar(inputPointers_.data(), outputPointers_.data(), chunk);
+        offset += chunk;
+        hopPosition_ = (hopPosition_ + chunk) % hopSize_;
+    }
+}
\ No newline at end of file
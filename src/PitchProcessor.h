@@ -0,0 +1,96 @@
+#pragma once
+#include "Arena.h"
+#include "ArenaPtr.h"
+#include "PitchEngine.h"
+#include "PitchShifter.h"
+#include "PitchDetector.h"
+#include "FormantCorrector.h"
+#include "Scale.h"
+#include "ParameterMailbox.h"
+#include "SmoothedValue.h"
+#include <atomic>
+#include <cstddef>
+
+struct PitchProcessorConfig {
+    EngineType engine = EngineType::Granular;
+    float sampleRate = 44100.0f;
+    size_t numChannels = 1;
+    // Processing hop. Host blocks of any length are split at multiples of it,
+    // counted from the start of the stream, and parameter and tracking
+    // updates only land on hop boundaries, so output doesn't depend on how
+    // the host sizes its blocks.
+    size_t hopSize = 256;
+    float grainMs = PitchShifter::kDefaultGrainMs;
+    WindowShape windowShape = WindowShape::Hann;
+    float semitones = 0.0f;
+    float mixLevel = 1.0f;
+    float outputGain = 1.0f;
+    bool trackPitch = false;
+    bool snapToScale = false;  // Implies trackPitch
+    Scale scale;
+    bool compensateDry = false;  // Delay the dry path to line up with the wet
+    bool preserveFormants = false;  // Keep the input's spectral envelope
+    // Extra arena capacity for host state, such as a meter, that should share
+    // the processor's block; hosts carve it through getArena()
+    size_t hostArenaBytes = 0;
+};
+
+// The complete DSP chain behind one stream, independent of any audio API:
+// pitch engine, optional pitch tracking with scale snapping, optional formant
+// correction, and output gain.
+// The engine, tracker, corrector and every buffer they own are carved from
+// one arena sized at construction, so processing never allocates. Hosts call
+// process* from their audio thread with blocks of any size, from a single
+// frame to many hops; parameters may be set from any thread and are picked
+// up, with ramps, at the start of the next hop.
+class PitchProcessor {
+public:
+    explicit PitchProcessor(const PitchProcessorConfig& config);
+    ~PitchProcessor();
+    
+    PitchProcessor(const PitchProcessor&) = delete;
+    PitchProcessor& operator=(const PitchProcessor&) = delete;
+    
+    // Any thread
+    void setSemitones(float semitones);
+    void setMixLevel(float mix);
+    void setOutputGain(float gain);
+    ParameterMailbox& getParameters() { return parameters_; }
+    
+    // Audio thread. Input and output may alias for in-place processing.
+    void processInterleaved(const float* input, float* output, size_t numFrames);
+    void processPlanar(const float* const* inputs, float* const* outputs, size_t numFrames);
+    
+    // Any thread. Algorithmic delay of the wet signal, and of the dry signal
+    // when it is compensated, as of the start of the current hop; hosts add
+    // their own buffering on top
+    size_t getLatencySamples() const { return latency_.load(std::memory_order_relaxed); }
+    size_t getNumChannels() const { return numChannels_; }
+    size_t getMemoryUsed() const { return arena_.getUsed(); }
+    Arena& getArena() { return arena_; }
+    PitchEngine& getEngine() { return *engine_; }
+    
+private:
+    static size_t measure(const PitchProcessorConfig& config);
+    void beginHop();
+    void fetchParameters();
+    void applyPitchTracking();
+    void processChunkInterleaved(const float* input, float* output, size_t numFrames);
+    void processChunkPlanar(const float* const* inputs, float* const* outputs, size_t numFrames);
+    
+    Arena arena_;  // Declared first so it outlives everything carved from it
+    ArenaPtr<PitchEngine> engine_;
+    ArenaPtr<PitchDetector> detector_;  // Null unless tracking
+    ArenaPtr<FormantCorrector> formants_;  // Null unless preserving formants
+    AlignedArray<const float*> inputPointers_;  // Planar chunk views
+    AlignedArray<float*> outputPointers_;
+    size_t numChannels_;
+    size_t hopSize_;
+    size_t hopPosition_;  // Frames already processed in the current hop
+    bool snapToScale_;
+    Scale scale_;
+    float pitchRatio_;  // Requested ratio before scale snapping
+    ParameterMailbox parameters_;
+    SmoothedValue outputGain_;
+    std::atomic<size_t> latency_;  // The engine's, republished at each hop
+};
\ No newline at end of file
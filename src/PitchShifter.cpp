@@ -2,135 +2,275 @@
 #include <algorithm>
 #include <cstring>
 
-PitchShifter::PitchShifter(size_t bufferSize, float sampleRate)
-    : sampleRate_(sampleRate)
-    , bufferSize_(bufferSize)
+namespace {
+// Keeps the interpolation filter's newest tap inside the written region
+const float kMinDelay = PolyphaseFilterBank::kMinDelay;
+const float kTukeyTaper = 0.5f;
+const size_t kMinGrainSize = 16;
+}
+
+PitchShifter::PitchShifter(size_t bufferSize, float sampleRate, size_t numChannels, float grainMs)
+    : PitchEngine(bufferSize, numChannels)
+    , sampleRate_(sampleRate)
     , pitchRatio_(1.0f)
     , mixLevel_(1.0f)  // Default to 100% wet
-    , grainSize_(1024.0f)
-    , readHead1_(0.0f)
-    , readHead2_(0.0f)
-    , grainPhase1_(0.0f)
-    , grainPhase2_(0.5f)  // Start second grain halfway through
-    , grain1Active_(true)
-    , samplesSinceLastGrain_(0)
-    , grainOverlap_(512) {
-    
-    // Create a larger buffer for pitch shifting (4x size for good margin)
-    buffer_ = new RingBuffer(bufferSize * 4);
-    
-    // Initialize lowpass filter (simple 3-tap FIR)
-    filterHistory_[0] = filterHistory_[1] = filterHistory_[2] = 0.0f;
-    // Normalized coefficients for simple averaging filter
-    filterCoeffs_[0] = 0.25f;
-    filterCoeffs_[1] = 0.5f;
-    filterCoeffs_[2] = 0.25f;
+    , started_(false)
+    , readHead1_(kMinDelay)
+    , readHead2_(kMinDelay)
+    , grainPosition1_(0)
+    , pitchPeriod_(0.0f)
+    , dryDelay_(0)
+    , dryFadeFrom_(0)
+    , dryFadePosition_(bufferSize)
+    , filterBank_(PolyphaseFilterBank::get())
+    , bank_(nullptr)
+    , bankAge_(0) {
+    
+    // Grains overlap by half, so keep the length even
+    size_t grainSamples = static_cast<size_t>(std::lround(grainMs * sampleRate_ / 2000.0f)) * 2;
+    grainSize_ = std::max<size_t>(kMinGrainSize, grainSamples);
+    grainOverlap_ = grainSize_ / 2;
+    grainPosition2_ = grainOverlap_;  // Start second grain halfway through
+    
+    size_t smoothingSamples = static_cast<size_t>(kSmoothingMs * sampleRate_ / 1000.0f);
+    pitchRatio_.setRampLength(smoothingSamples);
+    mixLevel_.setRampLength(smoothingSamples);
+    
+    // Read heads lag the write head by at most one grain of drift (ratio 2.0),
+    // plus the block just written and the interpolation filter's older taps
+    maxDelay_ = kMinDelay + grainSize_;
+    size_t bufferLength = bufferSize + static_cast<size_t>(maxDelay_) + PolyphaseFilterBank::kTaps;
+    buffers_ = makeArenaArray<RingBuffer>(numChannels_, bufferLength);
+    
+    windowTable_.resize(grainSize_ + bufferSize_);
+    buildWindowTable(WindowShape::Hann);
+    
+    delays1_.resize(bufferSize_);
+    delays2_.resize(bufferSize_);
+    mixRamp_.resize(bufferSize_);
+    taps1_.resize(bufferSize_);
+    taps2_.resize(bufferSize_);
+    dry_.resize(bufferSize_);
+    dryFrom_.resize(bufferSize_);
 }
 
-PitchShifter::~PitchShifter() {
-    delete buffer_;
-}
+PitchShifter::~PitchShifter() = default;
 
 void PitchShifter::setPitchRatio(float ratio) {
     // Clamp to ±1 octave (0.5 to 2.0)
-    pitchRatio_ = std::max(0.5f, std::min(2.0f, ratio));
+    ratio = std::max(0.5f, std::min(2.0f, ratio));
+    if (started_) {
+        // Trackers re-send the same ratio every block; don't restart the ramp
+        if (ratio != pitchRatio_.getTarget()) {
+            pitchRatio_.setTarget(ratio);
+        }
+    } else {
+        pitchRatio_.snap(ratio);
+    }
 }
 
 void PitchShifter::setMixLevel(float mix) {
-    mixLevel_ = std::max(0.0f, std::min(1.0f, mix));
+    mix = std::max(0.0f, std::min(1.0f, mix));
+    if (started_) {
+        mixLevel_.setTarget(mix);
+    } else {
+        mixLevel_.snap(mix);
+    }
+}
+
+void PitchShifter::setPitchPeriod(float samples) {
+    pitchPeriod_ = samples > 0.0f ? samples : 0.0f;
 }
 
-float PitchShifter::linearInterpolate(float a, float b, float fraction) {
-    return a + fraction * (b - a);
+void PitchShifter::setWindowShape(WindowShape shape) {
+    buildWindowTable(shape);
+}
+
+void PitchShifter::buildWindowTable(WindowShape shape) {
+    const double twoPi = 2.0 * M_PI;
+    float* table = windowTable_.data();
+    
+    for (size_t i = 0; i < grainSize_; ++i) {
+        double phase = static_cast<double>(i) / grainSize_;
+        double value;
+        switch (shape) {
+            case WindowShape::Tukey:
+                if (phase < kTukeyTaper / 2) {
+                    value = 0.5 * (1.0 - std::cos(twoPi * phase / kTukeyTaper));
+                } else if (phase > 1.0 - kTukeyTaper / 2) {
+                    value = 0.5 * (1.0 - std::cos(twoPi * (1.0 - phase) / kTukeyTaper));
+                } else {
+                    value = 1.0;
+                }
+                break;
+            case WindowShape::Blackman:
+                value = 0.42 - 0.5 * std::cos(twoPi * phase) + 0.08 * std::cos(2.0 * twoPi * phase);
+                break;
+            case WindowShape::Hann:
+            default:
+                value = 0.5 * (1.0 - std::cos(twoPi * phase));
+                break;
+        }
+        table[i] = static_cast<float>(value);
+    }
+    
+    // Normalize so the two grains, grainOverlap_ apart, always sum to unity.
+    // A no-op for Hann; keeps the gain flat for the other shapes.
+    for (size_t i = 0; i < grainOverlap_; ++i) {
+        float sum = table[i] + table[i + grainOverlap_];
+        if (sum > 1e-6f) {
+            table[i] /= sum;
+            table[i + grainOverlap_] /= sum;
+        }
+    }
+    
+    for (size_t i = grainSize_; i < windowTable_.size(); ++i) {
+        table[i] = table[i % grainSize_];
+    }
+}
+
+float PitchShifter::getGrainStartDelay(float otherDelay) const {
+    // Rising pitch consumes delay, so those grains start a full sweep back
+    float delay = kMinDelay + grainSize_ * std::max(0.0f, pitchRatio_.getCurrent() - 1.0f);
+    if (pitchPeriod_ <= 0.0f) return delay;
+    
+    // Both heads drift at the same rate, so a whole-period offset from the
+    // other grain keeps them in phase for the whole overlap. Round away from
+    // the minimum delay so rising grains don't stall against it.
+    float aligned = otherDelay + std::ceil((delay - otherDelay) / pitchPeriod_) * pitchPeriod_;
+    if (aligned > maxDelay_) {
+        aligned -= pitchPeriod_;
+    }
+    return aligned >= kMinDelay ? aligned : delay;
 }
 
-float PitchShifter::getGrainWindow(float phase) {
-    // Simple Hann window
-    if (phase < 0.0f || phase > 1.0f) return 0.0f;
-    return 0.5f * (1.0f - std::cos(2.0f * M_PI * phase));
+size_t PitchShifter::getLatencySamples() const {
+    float sweep = grainSize_ * std::fabs(1.0f - pitchRatio_.getTarget());
+    return static_cast<size_t>(std::lround(kMinDelay + 0.5f * sweep));
 }
 
-float PitchShifter::applyLowpassFilter(float input) {
-    // Shift history
-    filterHistory_[2] = filterHistory_[1];
-    filterHistory_[1] = filterHistory_[0];
-    filterHistory_[0] = input;
-    
-    // Apply FIR filter
-    return filterCoeffs_[0] * filterHistory_[0] + 
-           filterCoeffs_[1] * filterHistory_[1] + 
-           filterCoeffs_[2] * filterHistory_[2];
+size_t PitchShifter::getMaxLatencySamples() const {
+    // The sweep peaks at a full grain an octave up
+    return static_cast<size_t>(std::lround(kMinDelay + 0.5f * grainSize_));
 }
 
-void PitchShifter::processBlock(const float* input, float* output, size_t numSamples) {
-    // Write input to buffer
-    buffer_->write(input, numSamples);
+void PitchShifter::scheduleGrains(size_t numSamples) {
+    double* delays1 = delays1_.data();
+    double* delays2 = delays2_.data();
     
     for (size_t i = 0; i < numSamples; ++i) {
-        float sample1 = 0.0f, sample2 = 0.0f;
+        const float drift = 1.0f - pitchRatio_.next();
         
-        // Process grain 1
-        if (grainPhase1_ >= 0.0f && grainPhase1_ < 1.0f) {
-            // Calculate buffer read position for grain 1
-            float bufferPos = readHead1_;
-            size_t pos1 = static_cast<size_t>(bufferPos) % buffer_->getSize();
-            size_t pos2 = (pos1 + 1) % buffer_->getSize();
-            
-            // Get samples for interpolation
-            float tempBuffer[2];
-            buffer_->read(tempBuffer, 1);  // Read current sample
-            float samp1 = tempBuffer[0];
-            
-            // Simple approximation for interpolation (would need better buffer access in real implementation)
-            float fraction = bufferPos - std::floor(bufferPos);
-            sample1 = samp1 * getGrainWindow(grainPhase1_);
-            
-            readHead1_ += pitchRatio_;
-            if (readHead1_ >= buffer_->getSize()) {
-                readHead1_ -= buffer_->getSize();
-            }
-        }
+        // Sample i sits this far behind the write head after the block write;
+        // the sum is exact, so how blocks are split doesn't change the reads
+        double age = static_cast<double>(numSamples - 1 - i);
+        delays1[i] = readHead1_ + age;
+        delays2[i] = readHead2_ + age;
         
-        // Process grain 2
-        if (grainPhase2_ >= 0.0f && grainPhase2_ < 1.0f) {
-            // Calculate buffer read position for grain 2
-            float bufferPos = readHead2_;
-            size_t pos1 = static_cast<size_t>(bufferPos) % buffer_->getSize();
-            
-            // Get sample for grain 2
-            float tempBuffer[2];
-            buffer_->read(tempBuffer, 1);
-            float samp2 = tempBuffer[0];
-            
-            sample2 = samp2 * getGrainWindow(grainPhase2_);
-            
-            readHead2_ += pitchRatio_;
-            if (readHead2_ >= buffer_->getSize()) {
-                readHead2_ -= buffer_->getSize();
-            }
+        readHead1_ = std::max(kMinDelay, std::min(maxDelay_, readHead1_ + drift));
+        readHead2_ = std::max(kMinDelay, std::min(maxDelay_, readHead2_ + drift));
+        if (++grainPosition1_ == grainSize_) {
+            grainPosition1_ = 0;
+            readHead1_ = getGrainStartDelay(readHead2_);
         }
+        if (++grainPosition2_ == grainSize_) {
+            grainPosition2_ = 0;
+            readHead2_ = getGrainStartDelay(readHead1_);
+        }
+    }
+}
+
+void PitchShifter::processChunk(const float* const* inputs, float* const* outputs, size_t numSamples) {
+    if (numSamples == 0) return;
+    const bool firstChunk = !started_;
+    started_ = true;
+    
+    // Grain timing, mix ramps and the filter bank are shared by every lane.
+    // The bank covers the highest ratio a ramp can reach before it is
+    // picked again.
+    const float* window1 = windowTable_.data() + grainPosition1_;
+    const float* window2 = windowTable_.data() + grainPosition2_;
+    if (bankAge_ == 0) {
+        bank_ = filterBank_.getBank(std::max(pitchRatio_.getCurrent(), pitchRatio_.getTarget()));
+    }
+    bankAge_ = (bankAge_ + numSamples) % bufferSize_;
+    const float* filterBank = bank_;
+    scheduleGrains(numSamples);
+    
+    const bool mixRamping = mixLevel_.isRamping();
+    if (mixRamping) {
+        for (size_t i = 0; i < numSamples; ++i) {
+            mixRamp_[i] = mixLevel_.next();
+        }
+    }
+    
+    const float dryGain = 1.0f - mixLevel_.getCurrent();
+    const float wetGain = mixLevel_.getCurrent();
+    const float* __restrict mixRamp = mixRamp_.data();
+    
+    // The compensated dry path taps the delay line at the current latency.
+    // When that moves (or compensation is toggled mid-stream) the old and new
+    // taps are cross-faded over bufferSize_ samples, however the chunks fall.
+    const size_t targetDryDelay = compensateDry_ ? getLatencySamples() : 0;
+    if (firstChunk) {
+        dryDelay_ = targetDryDelay;
+    } else if (targetDryDelay != dryDelay_) {
+        dryFadeFrom_ = dryDelay_;
+        dryDelay_ = targetDryDelay;
+        dryFadePosition_ = 0;
+    }
+    const bool dryFading = dryFadePosition_ < bufferSize_;
+    const float fadeStep = 1.0f / static_cast<float>(bufferSize_);
+    
+    const double* __restrict delays1 = delays1_.data();
+    const double* __restrict delays2 = delays2_.data();
+    float* __restrict taps1 = taps1_.data();
+    float* __restrict taps2 = taps2_.data();
+    
+    for (size_t ch = 0; ch < numChannels_; ++ch) {
+        const float* input = inputs[ch];
+        float* output = outputs[ch];
+        RingBuffer& buffer = buffers_[ch];
         
-        // Cross-fade between grains and apply anti-aliasing filter
-        float wetSample = applyLowpassFilter(sample1 + sample2);
-        
-        // Mix dry and wet signals
-        output[i] = (1.0f - mixLevel_) * input[i] + mixLevel_ * wetSample;
-        
-        // Update grain phases
-        grainPhase1_ += 1.0f / grainSize_;
-        grainPhase2_ += 1.0f / grainSize_;
+        buffer.write(input, numSamples);
         
-        // Reset grains when they complete
-        if (grainPhase1_ >= 1.0f) {
-            grainPhase1_ = -0.5f;  // Start next grain with overlap
-            readHead1_ = readHead2_ - grainOverlap_;
-            if (readHead1_ < 0) readHead1_ += buffer_->getSize();
+        const float* dry = input;
+        if (dryFading) {
+            float* dryFrom = dryFrom_.data();
+            buffer.peekBlock(dryFadeFrom_, dryFrom, numSamples);
+            buffer.peekBlock(dryDelay_, dry_.data(), numSamples);
+            for (size_t i = 0; i < numSamples; ++i) {
+                float fade = std::min(1.0f, (dryFadePosition_ + i + 1) * fadeStep);
+                dry_[i] = dryFrom[i] + fade * (dry_[i] - dryFrom[i]);
+            }
+            dry = dry_.data();
+        } else if (dryDelay_ > 0) {
+            buffer.peekBlock(dryDelay_, dry_.data(), numSamples);
+            dry = dry_.data();
         }
         
-        if (grainPhase2_ >= 1.0f) {
-            grainPhase2_ = -0.5f;  // Start next grain with overlap
-            readHead2_ = readHead1_ - grainOverlap_;
-            if (readHead2_ < 0) readHead2_ += buffer_->getSize();
+        // Band-limited reads: one short dot product per tap position
+        buffer.peekPolyphase(delays1, filterBank, PolyphaseFilterBank::kTaps, PolyphaseFilterBank::kPhases,
+                             taps1, numSamples);
+        buffer.peekPolyphase(delays2, filterBank, PolyphaseFilterBank::kTaps, PolyphaseFilterBank::kPhases,
+                             taps2, numSamples);
+        
+        // Windowing, cross-fade and mix are straight-line loops over aligned
+        // arrays that the compiler vectorizes
+        if (mixRamping) {
+            for (size_t i = 0; i < numSamples; ++i) {
+                float wet = taps1[i] * window1[i] + taps2[i] * window2[i];
+                output[i] = (1.0f - mixRamp[i]) * dry[i] + mixRamp[i] * wet;
+            }
+        } else {
+            for (size_t i = 0; i < numSamples; ++i) {
+                float wet = taps1[i] * window1[i] + taps2[i] * window2[i];
+                output[i] = dryGain * dry[i] + wetGain * wet;
+            }
         }
     }
+    
+    if (dryFading) {
+        dryFadePosition_ = std::min(bufferSize_, dryFadePosition_ + numSamples);
+    }
 }
\ No newline at end of file
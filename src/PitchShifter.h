@@ -1,40 +1,107 @@
 #pragma once
+#include "PitchEngine.h"
 #include "RingBuffer.h"
+#include "AlignedBuffer.h"
+#include "SmoothedValue.h"
+#include "PolyphaseFilterBank.h"
 #include <cmath>
 
-class PitchShifter {
+enum class WindowShape {
+    Hann,
+    Tukey,
+    Blackman
+};
+
+// Granular delay-line pitch shifter. Each channel is a lane with its own
+// delay line, while grain timing and read-head delays are shared across lanes
+// so multichannel images stay phase-coherent. Grains are read through a
+// windowed-sinc polyphase filter whose cutoff follows the pitch ratio, so
+// pitching up doesn't fold high frequencies back down as aliases.
+class PitchShifter : public PitchEngine {
 public:
-    PitchShifter(size_t bufferSize, float sampleRate);
-    ~PitchShifter();
+    // 1024 samples at 44.1 kHz
+    static constexpr float kDefaultGrainMs = 1024.0f * 1000.0f / 44100.0f;
+    // 256 samples at 44.1 kHz: about 3 ms (135 samples) of latency at ±1
+    // octave, at the cost of rougher low voices unless grains are aligned by
+    // pitch tracking
+    static constexpr float kLowLatencyGrainMs = 256.0f * 1000.0f / 44100.0f;
+    static constexpr float kSmoothingMs = 20.0f;
+    
+    // Grain length is given in milliseconds and converted to samples for
+    // sampleRate, so timing and latency stay the same at any rate
+    PitchShifter(size_t bufferSize, float sampleRate, size_t numChannels = 1,
+                 float grainMs = kDefaultGrainMs);
+    ~PitchShifter() override;
+    
+    // Safe to call from the audio thread between blocks. Once processing has
+    // started, changes ramp over kSmoothingMs instead of jumping.
+    void setPitchRatio(float ratio) override;
+    void setMixLevel(float mix) override;  // 0.0 = dry, 1.0 = wet
+    void setWindowShape(WindowShape shape);
+    
+    // PSOLA-style alignment: each new grain starts a whole number of periods
+    // away from the grain it cross-fades with, so the two overlap in phase
+    void setPitchPeriod(float samples) override;
+    
+    // Average read-head delay over a grain: half the drift sweep plus the
+    // interpolator's minimum delay
+    size_t getLatencySamples() const override;
+    size_t getMaxLatencySamples() const override;
     
-    void setPitchRatio(float ratio);
-    void setMixLevel(float mix);  // 0.0 = dry, 1.0 = wet
-    void processBlock(const float* input, float* output, size_t numSamples);
+    size_t getGrainSize() const { return grainSize_; }
+    
+protected:
+    void processChunk(const float* const* inputs, float* const* outputs, size_t numSamples) override;
     
 private:
-    float linearInterpolate(float a, float b, float fraction);
-    float getGrainWindow(float phase);
-    float applyLowpassFilter(float input);
+    void scheduleGrains(size_t numSamples);
+    void buildWindowTable(WindowShape shape);
+    float getGrainStartDelay(float otherDelay) const;
     
-    RingBuffer* buffer_;
+    ArenaPtr<RingBuffer[]> buffers_;  // One delay line per channel
     float sampleRate_;
-    size_t bufferSize_;
     
-    float pitchRatio_;
-    float mixLevel_;
-    float grainSize_;
+    SmoothedValue pitchRatio_;
+    SmoothedValue mixLevel_;
+    bool started_;
+    size_t grainSize_;
     
-    // Two read heads for cross-fading
+    // Two read heads for cross-fading, stored as fractional delays behind the
+    // delay line's write head. Each drifts by (1 - pitchRatio_) per sample.
     float readHead1_;
     float readHead2_;
-    float grainPhase1_;
-    float grainPhase2_;
     
-    bool grain1Active_;
-    size_t samplesSinceLastGrain_;
+    // Sample positions within each grain, grainOverlap_ apart
+    size_t grainPosition1_;
+    size_t grainPosition2_;
     size_t grainOverlap_;
+    float maxDelay_;
+    float pitchPeriod_;  // 0 = fixed grain starts
+    size_t dryDelay_;    // Dry tap behind the write head, 0 = uncompensated
+    size_t dryFadeFrom_;      // Tap being faded out after dryDelay_ moved
+    size_t dryFadePosition_;  // Samples into that fade, bufferSize_ when done
+    
+    // Grain window sampled once per grainSize_, extended periodically by
+    // bufferSize_ so any chunk reads one contiguous span of it
+    AlignedBuffer windowTable_;
+    
+    // Per-chunk read delays for each grain, computed once and shared by all
+    // channels
+    AlignedArray<double> delays1_;
+    AlignedArray<double> delays2_;
+    AlignedBuffer mixRamp_;
+    
+    // Shared interpolation tables, built on first use outside the audio thread.
+    // The bank in use is re-picked every bufferSize_ samples of the stream,
+    // not per chunk, so it doesn't depend on how the host splits blocks.
+    const PolyphaseFilterBank& filterBank_;
+    const float* bank_;
+    size_t bankAge_;  // Samples since bank_ was picked
     
-    // Simple FIR lowpass filter (3-tap)
-    float filterHistory_[3];
-    float filterCoeffs_[3];
+    // Per-channel scratch, reused lane by lane: band-limited grain reads, the
+    // compensated dry signal and the dry tap it is fading from
+    AlignedBuffer taps1_;
+    AlignedBuffer taps2_;
+    AlignedBuffer dry_;
+    AlignedBuffer dryFrom_;
 };
\ No newline at end of file
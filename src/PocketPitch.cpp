@@ -0,0 +1,115 @@
+#include "PocketPitch.h"
+#include "PitchProcessor.h"
+#include <new>
+
+struct pocketpitch {
+    explicit pocketpitch(const PitchProcessorConfig& config) : processor(config) {}
+    
+    PitchProcessor processor;
+};
+
+namespace {
+
+bool inRange(double value, double low, double high) {
+    return value >= low && value <= high;
+}
+
+} // namespace
+
+void pocketpitch_config_init(pocketpitch_config* config) {
+    if (!config) return;
+    config->engine = POCKETPITCH_ENGINE_GRANULAR;
+    config->sample_rate = 44100.0;
+    config->channels = 1;
+    config->block_size = 256;
+    config->grain_ms = PitchShifter::kDefaultGrainMs;
+    config->low_latency = 0;
+    config->compensate_dry = 0;
+    config->preserve_formants = 0;
+    config->semitones = 0.0f;
+    config->mix = 1.0f;
+    config->gain = 1.0f;
+    config->track_pitch = 0;
+    config->scale = nullptr;
+}
+
+pocketpitch* pocketpitch_create(const pocketpitch_config* config) {
+    if (!config ||
+        !inRange(config->sample_rate, 8000.0, 192000.0) ||
+        !inRange(config->channels, 1, 32) ||
+        !inRange(config->block_size, 16, 8192) ||
+        !inRange(config->grain_ms, 2.0, 100.0) ||
+        !inRange(config->semitones, -12.0, 12.0) ||
+        !inRange(config->mix, 0.0, 1.0) ||
+        !inRange(config->gain, 0.1, 2.0)) {
+        return nullptr;
+    }
+    
+    PitchProcessorConfig processorConfig;
+    switch (config->engine) {
+        case POCKETPITCH_ENGINE_GRANULAR:
+            processorConfig.engine = EngineType::Granular;
+            break;
+        case POCKETPITCH_ENGINE_VOCODER:
+            processorConfig.engine = EngineType::PhaseVocoder;
+            break;
+        default:
+            return nullptr;
+    }
+    processorConfig.sampleRate = static_cast<float>(config->sample_rate);
+    processorConfig.numChannels = config->channels;
+    processorConfig.hopSize = config->block_size;
+    processorConfig.grainMs = config->low_latency ? PitchShifter::kLowLatencyGrainMs : config->grain_ms;
+    processorConfig.compensateDry = config->compensate_dry != 0;
+    processorConfig.preserveFormants = config->preserve_formants != 0;
+    processorConfig.semitones = config->semitones;
+    processorConfig.mixLevel = config->mix;
+    processorConfig.outputGain = config->gain;
+    processorConfig.trackPitch = config->track_pitch != 0;
+    if (config->scale) {
+        if (!Scale::parse(config->scale, processorConfig.scale)) return nullptr;
+        processorConfig.snapToScale = true;
+    }
+    
+    try {
+        return new pocketpitch(processorConfig);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void pocketpitch_destroy(pocketpitch* handle) {
+    delete handle;
+}
+
+void pocketpitch_process(pocketpitch* handle, const float* input, float* output, size_t frames) {
+    handle->processor.processInterleaved(input, output, frames);
+}
+
+void pocketpitch_process_planar(pocketpitch* handle, const float* const* inputs, float* const* outputs,
+                                size_t frames) {
+    handle->processor.processPlanar(inputs, outputs, frames);
+}
+
+int pocketpitch_set_param(pocketpitch* handle, pocketpitch_param param, float value) {
+    switch (param) {
+        case POCKETPITCH_PARAM_SEMITONES:
+            if (!inRange(value, -12.0, 12.0)) return -1;
+            handle->processor.setSemitones(value);
+            return 0;
+        case POCKETPITCH_PARAM_MIX:
+            if (!inRange(value, 0.0, 1.0)) return -1;
+            handle->processor.setMixLevel(value);
+            return 0;
+        case POCKETPITCH_PARAM_GAIN:
+            if (!inRange(value, 0.1, 2.0)) return -1;
+            handle->processor.setOutputGain(value);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+size_t pocketpitch_get_latency(const pocketpitch* handle) {
+    return handle->processor.getLatencySamples();
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <stddef.h>
+
+/* C interface to the pocket-pitch DSP for embedding in other hosts (JACK,
+ * PipeWire, plugin wrappers, server pipelines). A handle owns one stream's
+ * complete DSP chain with all memory allocated at creation; processing never
+ * allocates, locks or blocks. C++ hosts can use PitchProcessor directly. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct pocketpitch pocketpitch;
+
+typedef enum {
+    POCKETPITCH_ENGINE_GRANULAR = 0,
+    POCKETPITCH_ENGINE_VOCODER = 1
+} pocketpitch_engine;
+
+typedef enum {
+    POCKETPITCH_PARAM_SEMITONES = 0,  /* -12 to +12 */
+    POCKETPITCH_PARAM_MIX = 1,        /* 0 = dry, 1 = wet */
+    POCKETPITCH_PARAM_GAIN = 2        /* Linear, 0.1 to 2 */
+} pocketpitch_param;
+
+typedef struct {
+    pocketpitch_engine engine;
+    double sample_rate;       /* 8000 to 192000 */
+    unsigned int channels;    /* 1 to 32 */
+    unsigned int block_size;  /* Processing hop, 16 to 8192; host blocks may be any size and give the same output */
+    float grain_ms;           /* Granular engine only, 2 to 100 */
+    int low_latency;          /* Non-zero to use short grains instead of grain_ms (granular only) */
+    int compensate_dry;       /* Non-zero to delay the dry signal to line up with the wet */
+    int preserve_formants;    /* Non-zero to keep the input's formants at the new pitch */
+    float semitones;
+    float mix;
+    float gain;
+    int track_pitch;          /* Non-zero to align grains to the tracked input pitch */
+    const char* scale;        /* Snap to "chromatic", "<key>-major" or "<key>-minor"; NULL for none */
+} pocketpitch_config;
+
+/* Fills config with the CLI's defaults: granular, 44.1 kHz mono, 256-frame
+ * chunks, no shift, fully wet, unity gain */
+void pocketpitch_config_init(pocketpitch_config* config);
+
+/* NULL if the configuration is out of range or memory runs out */
+pocketpitch* pocketpitch_create(const pocketpitch_config* config);
+void pocketpitch_destroy(pocketpitch* handle);
+
+/* Audio thread. Any number of frames per call; input and output may be the
+ * same buffer. Interleaved takes frames of `channels` samples, planar one
+ * buffer per channel. */
+void pocketpitch_process(pocketpitch* handle, const float* input, float* output, size_t frames);
+void pocketpitch_process_planar(pocketpitch* handle, const float* const* inputs, float* const* outputs,
+                                size_t frames);
+
+/* Any thread; applied with a short ramp from the next process call.
+ * Returns 0, or -1 for an unknown parameter or out-of-range value. */
+int pocketpitch_set_param(pocketpitch* handle, pocketpitch_param param, float value);
+
+/* Any thread. Algorithmic delay of the wet signal in frames (and of the dry
+ * signal when compensated), for host latency compensation. Granular latency
+ * follows the pitch ratio; the value is updated at the start of each internal
+ * hop, so a change made with set_param shows up once processing reaches it. */
+size_t pocketpitch_get_latency(const pocketpitch* handle);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "PolyphaseFilterBank.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Cutoff as a fraction of Nyquist / ratio, leaving room for the transition band
+const double kPassband = 0.9;
+const size_t kBankSize = (PolyphaseFilterBank::kPhases + 1) * PolyphaseFilterBank::kTaps;
+}
+
+const PolyphaseFilterBank& PolyphaseFilterBank::get() {
+    // Outlives any arena scope it is first used in, so always on the heap
+    Arena::Scope heap(nullptr);
+    static const PolyphaseFilterBank bank;
+    return bank;
+}
+
+PolyphaseFilterBank::PolyphaseFilterBank() {
+    table_.resize(kBanks * kBankSize);
+    const double halfWidth = kTaps / 2.0;
+    
+    for (size_t b = 0; b < kBanks; ++b) {
+        double ratio = 1.0 + static_cast<double>(b) / (kBanks - 1);
+        double cutoff = kPassband / ratio;
+        
+        for (size_t p = 0; p <= kPhases; ++p) {
+            // Row p interpolates alpha = p / kPhases past the tap at index
+            // kTaps / 2 - 1
+            double alpha = static_cast<double>(p) / kPhases;
+            float* row = table_.data() + b * kBankSize + p * kTaps;
+            double sum = 0.0;
+            double coeffs[kTaps];
+            
+            for (size_t k = 0; k < kTaps; ++k) {
+                double x = (halfWidth - 1.0) + alpha - static_cast<double>(k);
+                double sinc = std::fabs(x) < 1e-9 ? 1.0 : std::sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+                double w = std::fabs(x) >= halfWidth ? 0.0
+                         : 0.42 + 0.5 * std::cos(M_PI * x / halfWidth) + 0.08 * std::cos(2.0 * M_PI * x / halfWidth);
+                coeffs[k] = sinc * w;
+                sum += coeffs[k];
+            }
+            
+            // Unity DC gain for every phase, so sub-sample position never
+            // modulates the level
+            for (size_t k = 0; k < kTaps; ++k) {
+                row[k] = static_cast<float>(coeffs[k] / sum);
+            }
+        }
+    }
+}
+
+const float* PolyphaseFilterBank::getBank(float ratio) const {
+    float position = std::ceil((ratio - 1.0f) * (kBanks - 1));
+    size_t bank = static_cast<size_t>(std::max(0.0f, std::min<float>(kBanks - 1, position)));
+    return table_.data() + bank * kBankSize;
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include <cstddef>
+
+// Precomputed windowed-sinc fractional-delay filters for band-limited reads
+// from a delay line. Reading at ratio r > 1 compresses the spectrum, so
+// content above Nyquist / r would alias; each bank lowpasses at a cutoff
+// for one ratio step between 1.0 and 2.0 and is split into kPhases
+// sub-sample phases of kTaps coefficients. Tables are built once per
+// process and shared by every shifter.
+class PolyphaseFilterBank {
+public:
+    static constexpr size_t kTaps = 16;      // Multiple of 8 for the vector kernel
+    static constexpr size_t kPhases = 256;   // Sub-sample resolution, nearest phase
+    static constexpr size_t kBanks = 9;      // Ratios 1.0, 1.125, ... 2.0
+    
+    // Taps reach kTaps / 2 samples newer than the read position, so reads
+    // must stay at least this far behind the newest sample
+    static constexpr float kMinDelay = kTaps / 2 - 1;
+    
+    static const PolyphaseFilterBank& get();
+    
+    // (kPhases + 1) rows of kTaps coefficients whose cutoff is at or below
+    // Nyquist / ratio; ratios up to 1.0 get the full-band bank
+    const float* getBank(float ratio) const;
+    
+private:
+    PolyphaseFilterBank();
+    
+    AlignedBuffer table_;
+};
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "RealtimeGuard.h"
+
+#ifdef POCKET_PITCH_RT_GUARD
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <ostream>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+const size_t kNumKinds = static_cast<size_t>(RealtimeViolation::Count);
+const char* const kKindNames[kNumKinds] = {"heap allocations", "lock waits", "sleeps", "file I/O calls"};
+
+// Plain TLS with no constructor, so reading it inside malloc is safe
+thread_local int guardDepth = 0;
+std::atomic<size_t> violations[kNumKinds];
+
+inline void record(RealtimeViolation kind) {
+    if (guardDepth > 0) {
+        violations[static_cast<size_t>(kind)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Next definition of a libc symbol, looked up on first use
+template <typename Fn>
+Fn lookup(std::atomic<Fn>& slot, const char* name) {
+    Fn fn = slot.load(std::memory_order_relaxed);
+    if (!fn) {
+        fn = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+        slot.store(fn, std::memory_order_relaxed);
+    }
+    return fn;
+}
+
+std::atomic<int (*)(pthread_mutex_t*)> realMutexLock;
+std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*)> realCondWait;
+std::atomic<int (*)(pthread_cond_t*, pthread_mutex_t*, const timespec*)> realCondTimedWait;
+std::atomic<int (*)(const timespec*, timespec*)> realNanosleep;
+std::atomic<int (*)(clockid_t, int, const timespec*, timespec*)> realClockNanosleep;
+std::atomic<int (*)(useconds_t)> realUsleep;
+std::atomic<ssize_t (*)(int, void*, size_t)> realRead;
+std::atomic<ssize_t (*)(int, const void*, size_t)> realWrite;
+std::atomic<size_t (*)(const void*, size_t, size_t, FILE*)> realFwrite;
+std::atomic<int (*)(const char*, FILE*)> realFputs;
+std::atomic<int (*)(const char*)> realPuts;
+std::atomic<int (*)(FILE*)> realFflush;
+}
+
+RealtimeGuard::RealtimeGuard() {
+    ++guardDepth;
+}
+
+RealtimeGuard::~RealtimeGuard() {
+    --guardDepth;
+}
+
+size_t RealtimeGuard::getViolations(RealtimeViolation kind) {
+    return violations[static_cast<size_t>(kind)].load(std::memory_order_relaxed);
+}
+
+size_t RealtimeGuard::getTotalViolations() {
+    size_t total = 0;
+    for (size_t i = 0; i < kNumKinds; ++i) {
+        total += violations[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void RealtimeGuard::printReport(std::ostream& out) {
+    out << "Real-time guard: " << getTotalViolations() << " violations on the audio thread\n";
+    for (size_t i = 0; i < kNumKinds; ++i) {
+        size_t count = violations[i].load(std::memory_order_relaxed);
+        if (count > 0) {
+            out << "  " << kKindNames[i] << ": " << count << "\n";
+        }
+    }
+    out.flush();
+}
+
+// Interposed libc entry points. glibc's __libc_* allocator symbols reach the
+// real heap without dlsym, which itself allocates.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(size_t size) {
+    record(RealtimeViolation::Allocation);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    record(RealtimeViolation::Allocation);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    record(RealtimeViolation::Allocation);
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) {
+    if (pointer) {
+        record(RealtimeViolation::Allocation);
+    }
+    __libc_free(pointer);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    record(RealtimeViolation::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    record(RealtimeViolation::Allocation);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) {
+    record(RealtimeViolation::Allocation);
+    void* pointer = __libc_memalign(alignment, size);
+    if (!pointer) return ENOMEM;
+    *result = pointer;
+    return 0;
+}
+
+int pthread_mutex_lock(pthread_mutex_t* mutex) {
+    record(RealtimeViolation::Lock);
+    return lookup(realMutexLock, "pthread_mutex_lock")(mutex);
+}
+
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
+    record(RealtimeViolation::Lock);
+    return lookup(realCondWait, "pthread_cond_wait")(cond, mutex);
+}
+
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const timespec* deadline) {
+    record(RealtimeViolation::Lock);
+    return lookup(realCondTimedWait, "pthread_cond_timedwait")(cond, mutex, deadline);
+}
+
+int nanosleep(const timespec* duration, timespec* remaining) {
+    record(RealtimeViolation::Sleep);
+    return lookup(realNanosleep, "nanosleep")(duration, remaining);
+}
+
+int clock_nanosleep(clockid_t clock, int flags, const timespec* duration, timespec* remaining) {
+    record(RealtimeViolation::Sleep);
+    return lookup(realClockNanosleep, "clock_nanosleep")(clock, flags, duration, remaining);
+}
+
+int usleep(useconds_t microseconds) {
+    record(RealtimeViolation::Sleep);
+    return lookup(realUsleep, "usleep")(microseconds);
+}
+
+ssize_t read(int fd, void* data, size_t count) {
+    record(RealtimeViolation::FileIO);
+    return lookup(realRead, "read")(fd, data, count);
+}
+
+ssize_t write(int fd, const void* data, size_t count) {
+    record(RealtimeViolation::FileIO);
+    return lookup(realWrite, "write")(fd, data, count);
+}
+
+// stdio writes through libc-internal calls, so its entry points are wrapped too
+size_t fwrite(const void* data, size_t size, size_t count, FILE* stream) {
+    record(RealtimeViolation::FileIO);
+    return lookup(realFwrite, "fwrite")(data, size, count, stream);
+}
+
+int fputs(const char* text, FILE* stream) {
+    record(RealtimeViolation::FileIO);
+    return lookup(realFputs, "fputs")(text, stream);
+}
+
+int puts(const char* text) {
+    record(RealtimeViolation::FileIO);
+    return lookup(realPuts, "puts")(text);
+}
+
+int fflush(FILE* stream) {
+    record(RealtimeViolation::FileIO);
+    return lookup(realFflush, "fflush")(stream);
+}
+
+int printf(const char* format, ...) {
+    record(RealtimeViolation::FileIO);
+    va_list args;
+    va_start(args, format);
+    int result = vprintf(format, args);
+    va_end(args);
+    return result;
+}
+
+int fprintf(FILE* stream, const char* format, ...) {
+    record(RealtimeViolation::FileIO);
+    va_list args;
+    va_start(args, format);
+    int result = vfprintf(stream, format, args);
+    va_end(args);
+    return result;
+}
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+
+enum class RealtimeViolation {
+    Allocation,  // malloc/free family, and so operator new/delete
+    Lock,        // Mutex and condition variable waits
+    Sleep,
+    FileIO,      // read/write and stdio output
+    Count
+};
+
+// Debug trap for real-time safety. When built with POCKET_PITCH_RT_GUARD, the
+// heap and common blocking libc calls are interposed, and every call made on
+// a thread while a RealtimeGuard is alive there is counted by kind. Without
+// the option the guard compiles to nothing.
+class RealtimeGuard {
+public:
+#ifdef POCKET_PITCH_RT_GUARD
+    static constexpr bool kEnabled = true;
+    
+    RealtimeGuard();
+    ~RealtimeGuard();
+    
+    static size_t getViolations(RealtimeViolation kind);
+    static size_t getTotalViolations();
+    static void printReport(std::ostream& out);
+#else
+    static constexpr bool kEnabled = false;
+    
+    RealtimeGuard() {}
+    
+    static size_t getViolations(RealtimeViolation) { return 0; }
+    static size_t getTotalViolations() { return 0; }
+    static void printReport(std::ostream&) {}
+#endif
+    
+    RealtimeGuard(const RealtimeGuard&) = delete;
+    RealtimeGuard& operator=(const RealtimeGuard&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "RealtimeSetup.h"
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+namespace {
+
+const char* policyName(int policy) {
+    switch (policy) {
+        case SCHED_FIFO: return "SCHED_FIFO";
+        case SCHED_RR: return "SCHED_RR";
+        case SCHED_OTHER: return "SCHED_OTHER";
+        default: return "unknown policy";
+    }
+}
+
+} // namespace
+
+RealtimeSetup::RealtimeSetup(int priority)
+    : priority_(priority)
+    , memoryLocked_(false)
+    , lockError_(0)
+    , lockLimit_(0)
+    , reservedCpu_(-1)
+    , numOtherCpus_(0)
+    , recorded_(false)
+    , policy_(SCHED_OTHER)
+    , grantedPriority_(0)
+    , audioCpu_(-1) {
+#ifdef __linux__
+    CPU_ZERO(&otherCpus_);
+#endif
+}
+
+void RealtimeSetup::beforeOpen() {
+    // Current pages (the pre-faulted arenas, the filter tables) are locked
+    // now; future mappings such as the callback thread's stack are locked
+    // and faulted in as they are created
+    memoryLocked_ = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    if (!memoryLocked_) {
+        lockError_ = errno;
+        rlimit limit;
+        if (getrlimit(RLIMIT_MEMLOCK, &limit) == 0) {
+            lockLimit_ = limit.rlim_cur;
+        }
+    }
+    
+#ifdef __linux__
+    // Reserve the highest allowed CPU; interrupts tend to land on the low ones
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) < 2) return;
+    for (int cpu = CPU_SETSIZE - 1; cpu >= 0; --cpu) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            reservedCpu_ = cpu;
+            break;
+        }
+    }
+    otherCpus_ = allowed;
+    CPU_CLR(reservedCpu_, &otherCpus_);
+    numOtherCpus_ = CPU_COUNT(&otherCpus_);
+    
+    cpu_set_t reserved;
+    CPU_ZERO(&reserved);
+    CPU_SET(reservedCpu_, &reserved);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(reserved), &reserved) != 0) {
+        reservedCpu_ = -1;
+    }
+#endif
+}
+
+void RealtimeSetup::afterOpen() {
+#ifdef __linux__
+    if (reservedCpu_ >= 0) {
+        pthread_setaffinity_np(pthread_self(), sizeof(otherCpus_), &otherCpus_);
+    }
+#endif
+}
+
+void RealtimeSetup::recordAudioThread() {
+    if (recorded_.load(std::memory_order_relaxed)) return;
+    
+    sched_param param;
+    if (pthread_getschedparam(pthread_self(), &policy_, &param) == 0) {
+        grantedPriority_ = param.sched_priority;
+    }
+#ifdef __linux__
+    audioCpu_ = sched_getcpu();
+#endif
+    recorded_.store(true, std::memory_order_release);
+}
+
+void RealtimeSetup::printReport(std::ostream& out, std::chrono::milliseconds timeout) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!recorded_.load(std::memory_order_acquire) && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const bool recorded = recorded_.load(std::memory_order_acquire);
+    
+    out << "Realtime: ";
+    if (!recorded) {
+        out << "no callback yet, audio thread scheduling unknown";
+    } else if (policy_ == SCHED_FIFO || policy_ == SCHED_RR) {
+        out << "audio thread " << policyName(policy_) << " priority " << grantedPriority_
+            << " (requested " << priority_ << ")";
+    } else {
+        out << "not granted, audio thread runs " << policyName(policy_)
+            << " (needs an rtprio limit or CAP_SYS_NICE)";
+    }
+    out << std::endl;
+    
+    out << "Memory: ";
+    if (memoryLocked_) {
+        out << "locked, DSP buffers pre-faulted";
+    } else {
+        out << "not locked (mlockall: " << std::strerror(lockError_);
+        if (lockLimit_ == RLIM_INFINITY) {
+            out << ", memlock limit unlimited)";
+        } else {
+            out << ", memlock limit " << (lockLimit_ / 1024) << " KB)";
+        }
+    }
+    out << std::endl;
+    
+    out << "CPUs: ";
+    if (reservedCpu_ < 0) {
+        out << "not pinned (needs at least two usable CPUs)";
+    } else if (recorded && audioCpu_ >= 0 && audioCpu_ != reservedCpu_) {
+        out << "CPU " << reservedCpu_ << " reserved, but the audio thread runs on CPU " << audioCpu_
+            << " (created by the audio server); other threads on the remaining " << numOtherCpus_;
+    } else {
+        out << "audio thread on CPU " << reservedCpu_ << ", other threads on the remaining " << numOtherCpus_;
+    }
+    out << std::endl;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Opt-in real-time setup around the live audio stream (--realtime). The
+// callback thread's scheduling class is requested through RtAudio's stream
+// options; this locks all memory so nothing the DSP touches can be paged out,
+// reserves one CPU for the callback thread and keeps the meter, stats
+// reporter and control threads off it, and reports what the system granted
+// so operators can check it.
+class RealtimeSetup {
+public:
+    static constexpr int kDefaultPriority = 70;
+    
+    explicit RealtimeSetup(int priority);
+    
+    int getPriority() const { return priority_; }
+    
+    // Main thread, just before the stream opens: locks memory, then pins this
+    // thread to the reserved CPU so the callback thread the audio API creates
+    // inherits that affinity
+    void beforeOpen();
+    // Main thread, once the stream is open: moves this thread, and every
+    // thread it starts from now on, to the remaining CPUs
+    void afterOpen();
+    
+    // Audio thread: notes the scheduling and CPU it actually runs with. Only
+    // the first call makes system calls.
+    void recordAudioThread();
+    
+    // Waits up to timeout for the first callback, then prints what was granted
+    void printReport(std::ostream& out, std::chrono::milliseconds timeout) const;
+    
+private:
+    int priority_;
+    bool memoryLocked_;
+    int lockError_;
+    unsigned long long lockLimit_;  // RLIMIT_MEMLOCK in bytes when locking failed
+    int reservedCpu_;  // -1 when nothing was pinned
+    int numOtherCpus_;
+#ifdef __linux__
+    cpu_set_t otherCpus_;
+#endif
+    
+    // Written by the audio thread before recorded_ is released
+    std::atomic<bool> recorded_;
+    int policy_;
+    int grantedPriority_;
+    int audioCpu_;  // -1 when unknown
+};
\ No newline at end of file
@@ -2,12 +2,22 @@
 #include <algorithm>
 #include <cstring>
 
+namespace {
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}
+
 RingBuffer::RingBuffer(size_t size) 
-    : size_(size)
+    : size_(roundUpToPowerOfTwo(size))
+    , mask_(size_ - 1)
     , writeIndex_(0)
     , readIndex_(0) {
-    buffer_ = std::make_unique<float[]>(size_);
-    std::memset(buffer_.get(), 0, size_ * sizeof(float));
+    buffer_.resize(size_);
 }
 
 RingBuffer::~RingBuffer() = default;
@@ -17,9 +27,13 @@ void RingBuffer::write(const float* data, size_t numSamples) {
     
     size_t currentWrite = writeIndex_.load(std::memory_order_relaxed);
     
-    for (size_t i = 0; i < numSamples; ++i) {
-        buffer_[currentWrite] = data[i];
-        currentWrite = (currentWrite + 1) % size_;
+    // Copy in at most two contiguous spans per lap around the buffer
+    while (numSamples > 0) {
+        size_t span = std::min(numSamples, size_ - currentWrite);
+        std::memcpy(&buffer_[currentWrite], data, span * sizeof(float));
+        currentWrite = (currentWrite + span) & mask_;
+        data += span;
+        numSamples -= span;
     }
     
     writeIndex_.store(currentWrite, std::memory_order_release);
@@ -30,32 +44,86 @@ void RingBuffer::read(float* data, size_t numSamples) {
     
     size_t currentRead = readIndex_.load(std::memory_order_relaxed);
     
-    for (size_t i = 0; i < numSamples; ++i) {
-        data[i] = buffer_[currentRead];
-        currentRead = (currentRead + 1) % size_;
+    while (numSamples > 0) {
+        size_t span = std::min(numSamples, size_ - currentRead);
+        std::memcpy(data, &buffer_[currentRead], span * sizeof(float));
+        currentRead = (currentRead + span) & mask_;
+        data += span;
+        numSamples -= span;
     }
     
     readIndex_.store(currentRead, std::memory_order_release);
 }
 
+void RingBuffer::peekBlock(size_t delay, float* output, size_t numSamples) const {
+    size_t start = (writeIndex_.load(std::memory_order_relaxed) - delay - numSamples) & mask_;
+    
+    while (numSamples > 0) {
+        size_t span = std::min(numSamples, size_ - start);
+        std::memcpy(output, &buffer_[start], span * sizeof(float));
+        start = (start + span) & mask_;
+        output += span;
+        numSamples -= span;
+    }
+}
+
+void RingBuffer::peekPolyphase(const double* delays, const float* table, size_t numTaps, size_t numPhases,
+                               float* output, size_t numSamples) const {
+    const float* buffer = buffer_.data();
+    const size_t newest = writeIndex_.load(std::memory_order_relaxed) - 1;
+    const size_t reach = numTaps / 2;  // Taps newer than the read position
+    float wrapped[64];
+    
+    for (size_t i = 0; i < numSamples; ++i) {
+        size_t whole = static_cast<size_t>(delays[i]);
+        float alpha = 1.0f - static_cast<float>(delays[i] - static_cast<double>(whole));
+        size_t phase = static_cast<size_t>(alpha * numPhases + 0.5f);
+        const float* coeffs = table + phase * numTaps;
+        
+        // Oldest tap first; copy out the rare windows that straddle the end
+        size_t start = (newest - whole - reach) & mask_;
+        const float* taps = buffer + start;
+        if (start + numTaps > size_) {
+            for (size_t k = 0; k < numTaps; ++k) {
+                wrapped[k] = buffer[(start + k) & mask_];
+            }
+            taps = wrapped;
+        }
+        
+        // Eight independent accumulators so the dot product vectorizes
+        // without reassociating a single sum
+        float acc[8] = {};
+        for (size_t k = 0; k < numTaps; k += 8) {
+            for (size_t j = 0; j < 8; ++j) {
+                acc[j] += taps[k + j] * coeffs[k + j];
+            }
+        }
+        output[i] = ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+    }
+}
+
+size_t RingBuffer::tryWrite(const float* data, size_t numSamples) {
+    numSamples = std::min(numSamples, getAvailableForWrite());
+    write(data, numSamples);
+    return numSamples;
+}
+
+size_t RingBuffer::tryRead(float* data, size_t numSamples) {
+    numSamples = std::min(numSamples, getAvailableForRead());
+    read(data, numSamples);
+    return numSamples;
+}
+
 size_t RingBuffer::getAvailableForWrite() const {
     size_t write = writeIndex_.load(std::memory_order_acquire);
     size_t read = readIndex_.load(std::memory_order_acquire);
     
-    if (write >= read) {
-        return size_ - (write - read) - 1;
-    } else {
-        return read - write - 1;
-    }
+    return (read - write - 1) & mask_;
 }
 
 size_t RingBuffer::getAvailableForRead() const {
     size_t write = writeIndex_.load(std::memory_order_acquire);
     size_t read = readIndex_.load(std::memory_order_acquire);
     
-    if (write >= read) {
-        return write - read;
-    } else {
-        return size_ - (read - write);
-    }
+    return (write - read) & mask_;
 }
\ No newline at end of file
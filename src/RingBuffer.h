@@ -1,21 +1,47 @@
 #pragma once
+#include "AlignedBuffer.h"
 #include <atomic>
-#include <memory>
 
 class RingBuffer {
 public:
+    // Capacity is rounded up to a power of two so indices wrap with a mask
     explicit RingBuffer(size_t size);
     ~RingBuffer();
     
     void write(const float* data, size_t numSamples);
     void read(float* data, size_t numSamples);
+    
+    // Single-producer/single-consumer queue variants: never overwrite unread
+    // data and return the number of samples actually transferred
+    size_t tryWrite(const float* data, size_t numSamples);
+    size_t tryRead(float* data, size_t numSamples);
+    
+    // Random access relative to the write head, leaving readIndex_ alone.
+    // delay counts samples behind the most recently written one (0 = newest).
+    // peekBlock copies the numSamples samples ending delay behind the newest,
+    // oldest first: a block-sized integer delay line tap.
+    void peekBlock(size_t delay, float* output, size_t numSamples) const;
+    // Fractional reads for a block: each is a numTaps-point FIR whose row is
+    // picked from a polyphase table of (numPhases + 1) rows by the sub-sample
+    // position. numTaps must be a multiple of 8 up to 64, and delays at least
+    // numTaps / 2 - 1. Delays are double so that a fractional read position
+    // plus a whole number of samples stays exact, whatever the block length.
+    void peekPolyphase(const double* delays, const float* table, size_t numTaps, size_t numPhases,
+                       float* output, size_t numSamples) const;
+    
     size_t getSize() const { return size_; }
     size_t getAvailableForWrite() const;
     size_t getAvailableForRead() const;
     
 private:
-    std::unique_ptr<float[]> buffer_;
+    static constexpr size_t kCacheLineSize = 64;
+    
+    AlignedBuffer buffer_;
     size_t size_;
-    std::atomic<size_t> writeIndex_;
-    std::atomic<size_t> readIndex_;
+    size_t mask_;
+    
+    // Producer and consumer indices live on separate cache lines so the two
+    // threads of an SPSC queue don't invalidate each other's line
+    alignas(kCacheLineSize) std::atomic<size_t> writeIndex_;
+    alignas(kCacheLineSize) std::atomic<size_t> readIndex_;
 };
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Musical scale used to snap tracked pitches to the nearest in-scale note
+// (A4 = 440 Hz, equal temperament). Stored as a root pitch class plus a
+// 12-bit mask of the scale degrees above it.
+class Scale {
+public:
+    Scale() : root_(0), mask_(0xFFF) {}  // Chromatic
+    
+    // Accepts "chromatic" or "<key>-major" / "<key>-minor" (e.g. "a-minor",
+    // "f#-major", "bb-major")
+    static bool parse(const char* name, Scale& scale) {
+        if (std::strcmp(name, "chromatic") == 0) {
+            scale = Scale();
+            return true;
+        }
+        
+        static const int kNaturals[7] = {9, 11, 0, 2, 4, 5, 7};  // a..g
+        char letter = static_cast<char>(std::tolower(static_cast<unsigned char>(name[0])));
+        if (letter < 'a' || letter > 'g') return false;
+        int root = kNaturals[letter - 'a'];
+        const char* rest = name + 1;
+        if (*rest == '#') {
+            root += 1;
+            ++rest;
+        } else if (*rest == 'b') {
+            root += 11;
+            ++rest;
+        }
+        
+        uint16_t mask;
+        if (std::strcmp(rest, "-major") == 0) {
+            mask = 0xAB5;  // Degrees 0 2 4 5 7 9 11
+        } else if (std::strcmp(rest, "-minor") == 0) {
+            mask = 0x5AD;  // Natural minor: 0 2 3 5 7 8 10
+        } else {
+            return false;
+        }
+        scale.root_ = root % 12;
+        scale.mask_ = mask;
+        return true;
+    }
+    
+    // Nearest in-scale frequency to frequency
+    float snap(float frequency) const {
+        if (frequency <= 0.0f) return frequency;
+        float note = 69.0f + 12.0f * std::log2(frequency / 440.0f);
+        int nearest = static_cast<int>(std::lround(note));
+        
+        // Search outwards; every scale has a degree within six semitones
+        int best = nearest;
+        float bestDistance = 1e9f;
+        for (int offset = -6; offset <= 6; ++offset) {
+            int candidate = nearest + offset;
+            if (contains(candidate) && std::fabs(candidate - note) < bestDistance) {
+                best = candidate;
+                bestDistance = std::fabs(candidate - note);
+            }
+        }
+        return 440.0f * std::exp2((best - 69) / 12.0f);
+    }
+    
+private:
+    bool contains(int note) const {
+        int degree = ((note - root_) % 12 + 12) % 12;
+        return (mask_ >> degree) & 1;
+    }
+    
+    int root_;
+    uint16_t mask_;
+};
\ No newline at end of file
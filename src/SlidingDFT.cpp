@@ -0,0 +1,58 @@
+#include "SlidingDFT.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+SlidingDFT::SlidingDFT(size_t size, const size_t* bins, size_t numBins)
+    : numBins_(numBins)
+    , numTracked_(0) {
+    
+    // Every k - 1, k, k + 1 needed, sorted and deduplicated, so each
+    // triple sits contiguously
+    std::vector<size_t> tracked;
+    for (size_t i = 0; i < numBins_; ++i) {
+        tracked.insert(tracked.end(), {bins[i] - 1, bins[i], bins[i] + 1});
+    }
+    std::sort(tracked.begin(), tracked.end());
+    tracked.erase(std::unique(tracked.begin(), tracked.end()), tracked.end());
+    numTracked_ = tracked.size();
+    
+    lower_.resize(numBins_);
+    for (size_t i = 0; i < numBins_; ++i) {
+        lower_[i] = std::lower_bound(tracked.begin(), tracked.end(), bins[i] - 1) - tracked.begin();
+    }
+    
+    real_.resize(numTracked_);
+    imag_.resize(numTracked_);
+    rotationReal_.resize(numTracked_);
+    rotationImag_.resize(numTracked_);
+    for (size_t k = 0; k < numTracked_; ++k) {
+        double angle = 2.0 * M_PI * static_cast<double>(tracked[k]) / static_cast<double>(size);
+        rotationReal_[k] = std::cos(angle);
+        rotationImag_[k] = std::sin(angle);
+    }
+}
+
+void SlidingDFT::update(float newest, float oldest) {
+    const double change = static_cast<double>(newest) - static_cast<double>(oldest);
+    double* real = real_.data();
+    double* imag = imag_.data();
+    const double* rotationReal = rotationReal_.data();
+    const double* rotationImag = rotationImag_.data();
+    
+    // Independent per bin, so this vectorizes
+    for (size_t k = 0; k < numTracked_; ++k) {
+        double re = real[k] + change;
+        double im = imag[k];
+        real[k] = re * rotationReal[k] - im * rotationImag[k];
+        imag[k] = re * rotationImag[k] + im * rotationReal[k];
+    }
+}
+
+float SlidingDFT::getWindowedPower(size_t index) const {
+    // Hann as a three-tap kernel in frequency: 0.5 X[k] - 0.25 (X[k-1] + X[k+1])
+    size_t k = lower_[index];
+    double re = 0.5 * real_[k + 1] - 0.25 * (real_[k] + real_[k + 2]);
+    double im = 0.5 * imag_[k + 1] - 0.25 * (imag_[k] + imag_[k + 2]);
+    return static_cast<float>(re * re + im * im);
+}
\ No newline at end of file
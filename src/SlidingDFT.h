@@ -0,0 +1,34 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include <cstddef>
+
+// Recursive DFT of a few bins over the last `size` samples, updated every
+// sample: X_k <- (X_k + x[n] - x[n - size]) * e^(j 2 pi k / size). Each
+// requested bin is tracked with its two neighbors so a Hann window can be
+// applied in the frequency domain; bins shared by several requests are
+// tracked once. Cost is per sample and per tracked bin, independent of the
+// window length, which makes long windows affordable when only a handful of
+// bins are needed. State is double precision so rounding doesn't build up
+// over long runs.
+class SlidingDFT {
+public:
+    // bins are indices into a size-point DFT, 1 to size/2 - 1
+    SlidingDFT(size_t size, const size_t* bins, size_t numBins);
+    
+    // newest enters the window as oldest, size samples older, leaves it
+    void update(float newest, float oldest);
+    
+    // |X_w|^2 of requested bin index under a periodic Hann window
+    float getWindowedPower(size_t index) const;
+    size_t getNumBins() const { return numBins_; }
+    
+private:
+    size_t numBins_;
+    size_t numTracked_;
+    AlignedArray<size_t> lower_;  // Per requested bin, tracked index of k - 1;
+                                  // k and k + 1 follow it
+    AlignedArray<double> real_;
+    AlignedArray<double> imag_;
+    AlignedArray<double> rotationReal_;
+    AlignedArray<double> rotationImag_;
+};
\ No newline at end of file
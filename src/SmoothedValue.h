@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+
+// Linear ramp towards a target over a fixed number of samples, used to
+// de-zipper parameters that change while audio is running.
+class SmoothedValue {
+public:
+    explicit SmoothedValue(float initial = 0.0f)
+        : current_(initial), target_(initial), step_(0.0f), remaining_(0), rampLength_(1) {}
+    
+    void setRampLength(size_t samples) { rampLength_ = samples > 0 ? samples : 1; }
+    
+    void setTarget(float target) {
+        target_ = target;
+        remaining_ = rampLength_;
+        step_ = (target_ - current_) / static_cast<float>(rampLength_);
+    }
+    
+    // Jump straight to value with no ramp
+    void snap(float value) {
+        current_ = target_ = value;
+        remaining_ = 0;
+    }
+    
+    float next() {
+        if (remaining_ == 0) return current_;
+        // Land exactly on the target at the end of the ramp
+        current_ = --remaining_ == 0 ? target_ : current_ + step_;
+        return current_;
+    }
+    
+    bool isRamping() const { return remaining_ > 0; }
+    float getCurrent() const { return current_; }
+    float getTarget() const { return target_; }
+    
+private:
+    float current_;
+    float target_;
+    float step_;
+    size_t remaining_;
+    size_t rampLength_;
+};
\ No newline at end of file
@@ -1,177 +1,377 @@
 #include "SpectralMeter.h"
 #include <iostream>
-#include <iomanip>
 #include <cmath>
+#include <cstdio>
 #include <algorithm>
+#include <chrono>
+#include <vector>
+#include <unistd.h>
 
-SpectralMeter::SpectralMeter(size_t fftSize) 
+namespace {
+// Queue holds about this much audio so a slow terminal doesn't drop samples
+const float kQueueSeconds = 0.35f;
+// Lowest band edge; raised to one bin when the analysis is too short to resolve it
+const float kMinFrequency = 40.0f;
+// With a sliding DFT, bands spanning fewer FFT bins than this use it instead
+const float kMinBinsPerBand = 2.0f;
+// Display range, and the level bands rest at in silence
+const float kFloorDb = -72.0f;
+// Ballistics: levels fall this fast after a peak, and the peak marker holds
+// for kPeakHoldSeconds before falling at its own rate
+const float kReleaseDbPerSecond = 24.0f;
+const float kPeakHoldSeconds = 1.0f;
+const float kPeakFallDbPerSecond = 12.0f;
+// Display layout: "%5dHz |" before each bar and "| %5.1f dB" after it, and
+// the rows around the bars (three above, three below)
+const size_t kLabelColumns = 9;
+const size_t kValueColumns = 10;
+const size_t kMinBarColumns = 10;
+const size_t kHeaderRows = 3;
+const size_t kFooterRows = 3;
+
+float toDb(float power) {
+    return std::max(kFloorDb, 10.0f * std::log10(std::max(power, 1e-12f)));
+}
+} // namespace
+
+SpectralMeter::SpectralMeter(size_t fftSize, float sampleRate, size_t hopSize, MeterAnalysis analysis,
+                             float frameIntervalMs)
     : fftSize_(fftSize)
+    , slidingSize_(analysis == MeterAnalysis::SlidingDFT ? fftSize * kSlidingFactor : 0)
+    , historyMask_(std::max(fftSize_, slidingSize_) - 1)
+    , sampleRate_(sampleRate)
+    , hopSize_(hopSize > 0 ? std::min(hopSize, fftSize) : fftSize / 4)
+    , analysis_(analysis)
+    , frameInterval_(static_cast<long>(frameIntervalMs * 1000.0f))
     , sampleCount_(0)
-    , displayCounter_(0) {
+    , sinceAnalysis_(0)
+    , fftPlan_(fftSize)
+    , numSlidingBands_(0)
+    , queue_(static_cast<size_t>(sampleRate * kQueueSeconds))
+    , droppedSamples_(0)
+    , droppedFrames_(0)
+    , renderer_(STDOUT_FILENO)
+    , frameHeight_(0)
+    , running_(false) {
     
-    inputBuffer_.resize(fftSize_);
-    fftBuffer_.resize(fftSize_);
-    magnitude_.resize(fftSize_ / 2);
-    window_ = generateHannWindow(fftSize_);
+    inputBuffer_.resize(historyMask_ + 1);
+    drainBuffer_.resize(fftSize_);
+    windowed_.resize(fftSize_);
+    spectrum_.resize(fftPlan_.getNumBins());
+    power_.resize(fftPlan_.getNumBins());
+    window_.resize(fftSize_);
+    generateHannWindow();
+    buildBands();
     
-    std::fill(inputBuffer_.begin(), inputBuffer_.end(), 0.0f);
+    measured_.assign(kNumBands, kFloorDb);
+    level_.assign(kNumBands, kFloorDb);
+    peak_.assign(kNumBands, kFloorDb);
+    peakAge_.assign(kNumBands, 0.0f);
 }
 
-SpectralMeter::~SpectralMeter() = default;
+SpectralMeter::~SpectralMeter() {
+    stop();
+}
 
-std::vector<float> SpectralMeter::generateHannWindow(size_t size) {
-    std::vector<float> window(size);
-    for (size_t i = 0; i < size; ++i) {
-        window[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (size - 1)));
+void SpectralMeter::generateHannWindow() {
+    // Periodic, matching the sliding DFT's frequency-domain window
+    for (size_t i = 0; i < fftSize_; ++i) {
+        window_[i] = 0.5f * (1.0f - std::cos(2.0f * static_cast<float>(M_PI) * i / fftSize_));
     }
-    return window;
 }
 
-void SpectralMeter::addSample(float sample) {
-    inputBuffer_[sampleCount_] = sample;
-    sampleCount_ = (sampleCount_ + 1) % fftSize_;
+// Log-spaced bands from kMinFrequency to Nyquist. Each bin contributes the
+// share of its width that falls inside a band; bands narrower than a bin get
+// their weights scaled up to one, so they read interpolated bin power rather
+// than a fraction of it.
+void SpectralMeter::buildBands() {
+    const float fftBinHz = sampleRate_ / fftSize_;
+    const float slidingBinHz = slidingSize_ > 0 ? sampleRate_ / slidingSize_ : fftBinHz;
+    const float low = std::max(kMinFrequency, slidingBinHz);
+    const float ratio = std::pow(0.5f * sampleRate_ / low, 1.0f / kNumBands);
     
-    // Update display every ~50ms (assuming 44.1kHz sample rate)
-    displayCounter_++;
-    if (displayCounter_ >= 2205) {  // 44100 / 20 = 2205 samples for 50ms
-        updateDisplay();
-        displayCounter_ = 0;
+    bandEdges_.resize(kNumBands + 1);
+    for (size_t band = 0; band <= kNumBands; ++band) {
+        bandEdges_[band] = low * std::pow(ratio, static_cast<float>(band));
     }
-}
-
-void SpectralMeter::updateDisplay() {
-    performFFT();
-    printSpectrum();
-}
-
-void SpectralMeter::performFFT() {
-    // Apply window and copy to FFT buffer
-    for (size_t i = 0; i < fftSize_; ++i) {
-        size_t bufferIndex = (sampleCount_ + i) % fftSize_;
-        fftBuffer_[i] = std::complex<float>(inputBuffer_[bufferIndex] * window_[i], 0.0f);
+    while (slidingSize_ > 0 && numSlidingBands_ < kNumBands &&
+           bandEdges_[numSlidingBands_ + 1] - bandEdges_[numSlidingBands_] < kMinBinsPerBand * fftBinHz) {
+        ++numSlidingBands_;
     }
     
-    // Perform FFT
-    fft(fftBuffer_);
+    // The sliding DFT needs a neighbor on each side for its window
+    auto binHz = [&](size_t band) { return band < numSlidingBands_ ? slidingBinHz : fftBinHz; };
+    auto lastBin = [&](size_t band) { return band < numSlidingBands_ ? slidingSize_ / 2 - 1 : fftSize_ / 2; };
+    auto overlap = [&](size_t band, size_t bin) {
+        float width = binHz(band);
+        float start = std::max(bandEdges_[band], (bin - 0.5f) * width);
+        float end = std::min(bandEdges_[band + 1], (bin + 0.5f) * width);
+        return std::max(0.0f, end - start) / width;
+    };
+    
+    // Count the non-zero entries, then fill them
+    bandStart_.resize(kNumBands + 1);
+    size_t entries = 0;
+    for (size_t band = 0; band < kNumBands; ++band) {
+        bandStart_[band] = entries;
+        for (size_t bin = 1; bin <= lastBin(band); ++bin) {
+            entries += overlap(band, bin) > 0.0f ? 1 : 0;
+        }
+    }
+    bandStart_[kNumBands] = entries;
+    bandBins_.resize(entries);
+    bandWeights_.resize(entries);
+    
+    // Bins ascend across the sliding bands, so repeats are always the
+    // previous entry
+    std::vector<size_t> slidingBins;
+    for (size_t band = 0; band < kNumBands; ++band) {
+        size_t entry = bandStart_[band];
+        float total = 0.0f;
+        for (size_t bin = 1; bin <= lastBin(band); ++bin) {
+            float weight = overlap(band, bin);
+            if (weight <= 0.0f) continue;
+            
+            if (band < numSlidingBands_) {
+                if (slidingBins.empty() || slidingBins.back() != bin) {
+                    slidingBins.push_back(bin);
+                }
+                bandBins_[entry] = slidingBins.size() - 1;
+            } else {
+                bandBins_[entry] = bin;
+            }
+            bandWeights_[entry] = weight;
+            total += weight;
+            ++entry;
+        }
+        if (total > 0.0f && total < 1.0f) {
+            for (size_t i = bandStart_[band]; i < entry; ++i) {
+                bandWeights_[i] /= total;
+            }
+        }
+    }
     
-    // Calculate magnitude spectrum
-    for (size_t i = 0; i < magnitude_.size(); ++i) {
-        magnitude_[i] = std::abs(fftBuffer_[i]);
+    if (numSlidingBands_ > 0) {
+        sliding_ = makeArenaObject<SlidingDFT>(slidingSize_, slidingBins.data(), slidingBins.size());
     }
 }
 
-size_t SpectralMeter::bitReversedIndex(size_t index, size_t bits) {
-    size_t reversed = 0;
-    for (size_t i = 0; i < bits; ++i) {
-        reversed = (reversed << 1) | (index & 1);
-        index >>= 1;
+void SpectralMeter::pushSamples(const float* samples, size_t numFrames, size_t numChannels) {
+    if (numChannels <= 1) {
+        size_t written = queue_.tryWrite(samples, numFrames);
+        if (written < numFrames) {
+            droppedSamples_.fetch_add(numFrames - written, std::memory_order_relaxed);
+        }
+        return;
+    }
+    
+    // Downmix through a small stack buffer so the audio thread never allocates
+    float mono[256];
+    const float scale = 1.0f / numChannels;
+    for (size_t offset = 0; offset < numFrames; offset += 256) {
+        size_t chunk = std::min<size_t>(256, numFrames - offset);
+        const float* frames = samples + offset * numChannels;
+        for (size_t i = 0; i < chunk; ++i) {
+            float sum = 0.0f;
+            for (size_t ch = 0; ch < numChannels; ++ch) {
+                sum += frames[i * numChannels + ch];
+            }
+            mono[i] = sum * scale;
+        }
+        pushSamples(mono, chunk);
     }
-    return reversed;
 }
 
-void SpectralMeter::bitReverse(std::vector<std::complex<float>>& data) {
-    size_t n = data.size();
-    size_t bits = 0;
-    size_t temp = n;
-    while (temp > 1) {
-        temp >>= 1;
-        bits++;
+void SpectralMeter::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&SpectralMeter::run, this);
+}
+
+void SpectralMeter::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) {
+        thread_.join();
     }
+    renderer_.finish(frameHeight_);
+    std::cout << "Meter output: " << renderer_.getAverageFrameBytes() << " bytes/frame on average" << std::endl;
+}
+
+void SpectralMeter::run() {
+    using Clock = std::chrono::steady_clock;
+    auto nextFrame = Clock::now() + frameInterval_;
     
-    for (size_t i = 0; i < n; ++i) {
-        size_t j = bitReversedIndex(i, bits);
-        if (i < j) {
-            std::swap(data[i], data[j]);
+    while (running_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_until(nextFrame);
+        drainQueue();
+        updateDisplay();
+        
+        // If drawing overran one or more frame slots, skip them rather than
+        // trying to catch up, and count them
+        nextFrame += frameInterval_;
+        auto now = Clock::now();
+        if (now > nextFrame) {
+            size_t missed = static_cast<size_t>((now - nextFrame) / frameInterval_) + 1;
+            droppedFrames_ += missed;
+            nextFrame += missed * frameInterval_;
         }
     }
 }
 
-void SpectralMeter::fft(std::vector<std::complex<float>>& data) {
-    size_t n = data.size();
-    
-    // Bit-reverse the input
-    bitReverse(data);
-    
-    // Perform FFT
-    for (size_t len = 2; len <= n; len <<= 1) {
-        float angle = -2.0f * M_PI / len;
-        std::complex<float> wlen(std::cos(angle), std::sin(angle));
+void SpectralMeter::drainQueue() {
+    size_t count;
+    while ((count = queue_.tryRead(drainBuffer_.data(), drainBuffer_.size())) > 0) {
+        analyze(drainBuffer_.data(), count);
+    }
+}
+
+void SpectralMeter::analyze(const float* samples, size_t numSamples) {
+    for (size_t i = 0; i < numSamples; ++i) {
+        // sampleCount_ indexes the oldest sample, which this one replaces;
+        // the ring is exactly the sliding DFT's length when there is one
+        float oldest = inputBuffer_[sampleCount_];
+        inputBuffer_[sampleCount_] = samples[i];
+        sampleCount_ = (sampleCount_ + 1) & historyMask_;
+        if (sliding_) {
+            sliding_->update(samples[i], oldest);
+        }
         
-        for (size_t i = 0; i < n; i += len) {
-            std::complex<float> w(1.0f, 0.0f);
-            
-            for (size_t j = 0; j < len / 2; ++j) {
-                std::complex<float> u = data[i + j];
-                std::complex<float> v = data[i + j + len / 2] * w;
-                
-                data[i + j] = u + v;
-                data[i + j + len / 2] = u - v;
-                
-                w *= wlen;
-            }
+        if (++sinceAnalysis_ == hopSize_) {
+            sinceAnalysis_ = 0;
+            measureBands();
+            applyBallistics();
         }
     }
 }
 
-void SpectralMeter::printSpectrum() {
-    const int barWidth = 60;
-    const int numBins = 32;  // Show 32 frequency bins
+void SpectralMeter::measureBands() {
+    // A Hann-windowed unit sine peaks at size / 4, and its main lobe sums to
+    // 1.5 times that bin's power
+    auto reference = [](size_t size) { return 1.5f * (0.25f * size) * (0.25f * size); };
     
-    // Group bins for display
-    std::vector<float> displayBins(numBins, 0.0f);
-    size_t binsPerDisplay = magnitude_.size() / numBins;
-    
-    for (int i = 0; i < numBins; ++i) {
-        float sum = 0.0f;
-        for (size_t j = 0; j < binsPerDisplay; ++j) {
-            size_t binIndex = i * binsPerDisplay + j;
-            if (binIndex < magnitude_.size()) {
-                sum += magnitude_[binIndex];
+    if (sliding_) {
+        const float slidingReference = reference(slidingSize_);
+        for (size_t band = 0; band < numSlidingBands_; ++band) {
+            float sum = 0.0f;
+            for (size_t i = bandStart_[band]; i < bandStart_[band + 1]; ++i) {
+                sum += sliding_->getWindowedPower(bandBins_[i]) * bandWeights_[i];
             }
+            measured_[band] = toDb(sum / slidingReference);
         }
-        displayBins[i] = sum / binsPerDisplay;
     }
     
-    // Find max for scaling
-    float maxVal = *std::max_element(displayBins.begin(), displayBins.end());
-    if (maxVal < 1e-6f) maxVal = 1e-6f;  // Avoid division by zero
+    // Apply window to the newest fftSize_ samples, oldest first
+    const size_t start = sampleCount_ - fftSize_;
+    for (size_t i = 0; i < fftSize_; ++i) {
+        windowed_[i] = inputBuffer_[(start + i) & historyMask_] * window_[i];
+    }
+    fftPlan_.forward(windowed_.data(), spectrum_.data());
+    for (size_t bin = 0; bin < power_.size(); ++bin) {
+        power_[bin] = std::norm(spectrum_[bin]);
+    }
+    
+    const float fftReference = reference(fftSize_);
+    for (size_t band = numSlidingBands_; band < kNumBands; ++band) {
+        float sum = 0.0f;
+        for (size_t i = bandStart_[band]; i < bandStart_[band + 1]; ++i) {
+            sum += power_[bandBins_[i]] * bandWeights_[i];
+        }
+        measured_[band] = toDb(sum / fftReference);
+    }
+}
+
+void SpectralMeter::applyBallistics() {
+    const float hopSeconds = hopSize_ / sampleRate_;
+    const float release = kReleaseDbPerSecond * hopSeconds;
+    const float fall = kPeakFallDbPerSecond * hopSeconds;
     
-    // Clear screen and move cursor to top
-    std::cout << "\033[2J\033[H";
+    for (size_t band = 0; band < kNumBands; ++band) {
+        level_[band] = std::max(measured_[band], level_[band] - release);
+        if (measured_[band] >= peak_[band]) {
+            peak_[band] = measured_[band];
+            peakAge_[band] = 0.0f;
+        } else {
+            peakAge_[band] += hopSeconds;
+            if (peakAge_[band] > kPeakHoldSeconds) {
+                peak_[band] = std::max(level_[band], peak_[band] - fall);
+            }
+        }
+    }
+}
+
+void SpectralMeter::updateDisplay() {
+    renderer_.updateSize();
+    printSpectrum();
+    renderer_.present();
+}
+
+// Composes the frame into the renderer. When the terminal is too short for
+// every band, adjacent bands share a row and show the loudest of them; bars
+// stretch to the terminal width.
+void SpectralMeter::printSpectrum() {
+    const size_t rows = renderer_.getRows();
+    const size_t columns = renderer_.getColumns();
+    const size_t barRows = std::max<size_t>(1, std::min(kNumBands, rows - std::min(rows, kHeaderRows + kFooterRows)));
+    const size_t bandsPerRow = (kNumBands + barRows - 1) / barRows;
+    const size_t numBars = (kNumBands + bandsPerRow - 1) / bandsPerRow;
+    const size_t barWidth = std::max(kMinBarColumns, columns - std::min(columns, kLabelColumns + kValueColumns));
+    const size_t width = kLabelColumns + barWidth + kValueColumns;
+    auto toColumn = [&](float db) {
+        return static_cast<size_t>((db - kFloorDb) / -kFloorDb * barWidth);
+    };
     
-    std::cout << "Pocket Pitch - Spectral Meter\n";
-    std::cout << "Frequency Analysis (32 bins, " << fftSize_ << "-point FFT)\n";
-    std::cout << std::string(barWidth + 10, '=') << "\n";
+    char line[256];
+    renderer_.clear();
+    renderer_.print(0, 0, "Pocket Pitch - Spectral Meter");
+    int length = std::snprintf(line, sizeof(line), "Frequency Analysis (%zu log bands, %zu-point FFT", kNumBands,
+                               fftSize_);
+    if (sliding_) {
+        length += std::snprintf(line + length, sizeof(line) - length, " + %zu-point sliding DFT below %d Hz",
+                                slidingSize_, static_cast<int>(bandEdges_[numSlidingBands_]));
+    }
+    std::snprintf(line + length, sizeof(line) - length, ", hop %zu)", hopSize_);
+    renderer_.print(1, 0, line);
+    for (size_t column = 0; column < width; ++column) {
+        renderer_.put(2, column, U'=');
+        renderer_.put(kHeaderRows + numBars, column, U'=');
+    }
     
-    // Print spectrum bars
-    for (int i = 0; i < numBins; ++i) {
-        float normalized = displayBins[i] / maxVal;
-        int barLength = static_cast<int>(normalized * barWidth);
+    // Spectrum bars, with the held peak as a marker
+    for (size_t bar = 0; bar < numBars; ++bar) {
+        const size_t row = kHeaderRows + bar;
+        const size_t first = bar * bandsPerRow;
+        const size_t last = std::min(kNumBands, first + bandsPerRow);
+        float level = *std::max_element(level_.begin() + first, level_.begin() + last);
+        float peak = *std::max_element(peak_.begin() + first, peak_.begin() + last);
+        size_t barLength = toColumn(level);
+        size_t peakColumn = std::min(barWidth - 1, toColumn(peak));
         
-        // Calculate frequency range for this bin
-        float freqStart = (i * 22050.0f) / numBins;  // Nyquist = 22050 Hz
-        float freqEnd = ((i + 1) * 22050.0f) / numBins;
-        
-        std::cout << std::setw(4) << static_cast<int>(freqStart) << "Hz |";
-        
-        // Print the bar
-        for (int j = 0; j < barWidth; ++j) {
+        std::snprintf(line, sizeof(line), "%5dHz |", static_cast<int>(bandEdges_[first]));
+        renderer_.print(row, 0, line);
+        for (size_t j = 0; j < barWidth; ++j) {
+            char32_t glyph = U' ';
             if (j < barLength) {
                 if (j < barWidth * 0.6f) {
-                    std::cout << "█";  // Full block
+                    glyph = U'\u2588';  // Full block
                 } else if (j < barWidth * 0.8f) {
-                    std::cout << "▓";  // Medium block
+                    glyph = U'\u2593';  // Dark shade
                 } else {
-                    std::cout << "░";  // Light block
+                    glyph = U'\u2591';  // Light shade
                 }
-            } else {
-                std::cout << " ";
+            } else if (j == peakColumn && peak > kFloorDb) {
+                glyph = U'\u258F';  // Left one-eighth block
             }
+            renderer_.put(row, kLabelColumns + j, glyph);
         }
-        
-        std::cout << "| " << std::fixed << std::setprecision(3) << normalized << "\n";
+        std::snprintf(line, sizeof(line), "| %5.1f dB", level);
+        renderer_.print(row, kLabelColumns + barWidth, line);
     }
     
-    std::cout << std::string(barWidth + 10, '=') << "\n";
-    std::cout << "Press Enter to quit...\n";
+    // Bytes of the previous frame; this one's are only known once it is sent
+    const size_t footer = kHeaderRows + numBars + 1;
+    std::snprintf(line, sizeof(line), "Dropped: %zu samples, %zu frames  Output: %zu bytes/frame (avg %zu)",
+                  getDroppedSamples(), droppedFrames_, renderer_.getLastFrameBytes(),
+                  renderer_.getAverageFrameBytes());
+    renderer_.print(footer, 0, line);
+    renderer_.print(footer + 1, 0, "Press Enter to quit...");
+    frameHeight_ = footer + 2;
 }
\ No newline at end of file
@@ -1,31 +1,114 @@
 #pragma once
-#include <vector>
 #include <complex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include "RingBuffer.h"
+#include "FFT.h"
+#include "SlidingDFT.h"
+#include "TerminalRenderer.h"
+#include "AlignedBuffer.h"
+#include "ArenaPtr.h"
 
+enum class MeterAnalysis {
+    FFT,        // Hann-windowed FFT every hop, summed into log bands
+    SlidingDFT  // As FFT, but bands too narrow for its bins come from a
+                // kSlidingFactor times longer sliding DFT, updated per sample
+};
+
+// Terminal spectrum analyzer. Queued audio is analyzed continuously, once
+// per hop rather than once per display frame, into log-spaced bands through
+// a precomputed sparse bin-to-band matrix. Band levels then go through meter
+// ballistics (instant attack, steady release, peak hold), so the display can
+// redraw at a high frame rate while each frame only reads the current levels
+// and sends the cells that changed.
 class SpectralMeter {
 public:
-    SpectralMeter(size_t fftSize = 1024);
+    static constexpr size_t kNumBands = 32;
+    static constexpr size_t kSlidingFactor = 8;
+    static constexpr float kDefaultFrameMs = 1000.0f / 30.0f;
+    
+    // hopSize 0 means fftSize / 4 (75% overlap)
+    SpectralMeter(size_t fftSize = 1024, float sampleRate = 44100.0f, size_t hopSize = 0,
+                  MeterAnalysis analysis = MeterAnalysis::FFT, float frameIntervalMs = kDefaultFrameMs);
     ~SpectralMeter();
     
-    void addSample(float sample);
+    // Audio thread: lock-free, never blocks. Samples that don't fit in the
+    // queue are counted as dropped instead of stalling the callback.
+    // Interleaved multichannel frames are averaged down to mono.
+    void pushSamples(const float* samples, size_t numFrames, size_t numChannels = 1);
+    
+    // Visualization thread lifecycle
+    void start();
+    void stop();
+    
+    // Visualization thread: runs mono samples through the analysis and
+    // ballistics; run() does this with whatever the audio thread queued
+    void analyze(const float* samples, size_t numSamples);
     void updateDisplay();
     
+    // Band levels after ballistics, in dB relative to a full-scale sine
+    const float* getLevels() const { return level_.data(); }
+    const float* getPeaks() const { return peak_.data(); }
+    float getBandFrequency(size_t band) const { return bandEdges_[band]; }  // Lower edge in Hz
+    size_t getNumSlidingBands() const { return numSlidingBands_; }
+    
+    size_t getDroppedSamples() const { return droppedSamples_.load(std::memory_order_relaxed); }
+    size_t getDroppedFrames() const { return droppedFrames_; }
+    
 private:
-    void performFFT();
+    void run();
+    void drainQueue();
+    void buildBands();
+    void measureBands();
+    void applyBallistics();
     void printSpectrum();
-    std::vector<float> generateHannWindow(size_t size);
+    void generateHannWindow();
     
     size_t fftSize_;
+    size_t slidingSize_;  // 0 without a sliding DFT
+    size_t historyMask_;
+    float sampleRate_;
+    size_t hopSize_;
+    MeterAnalysis analysis_;
+    std::chrono::microseconds frameInterval_;
     size_t sampleCount_;
-    size_t displayCounter_;
+    size_t sinceAnalysis_;
+    
+    AlignedBuffer inputBuffer_;  // Ring of the last max(fftSize_, slidingSize_) samples
+    AlignedBuffer window_;
+    AlignedBuffer windowed_;
+    AlignedArray<std::complex<float>> spectrum_;
+    AlignedBuffer power_;
+    RealFFTPlan fftPlan_;
+    ArenaPtr<SlidingDFT> sliding_;  // Only in SlidingDFT mode
+    
+    // Bin-to-band matrix in compressed rows: band b sums the power of bin
+    // bandBins_[i] times bandWeights_[i] for i in [bandStart_[b], bandStart_[b + 1]).
+    // The lowest numSlidingBands_ bands index the sliding DFT's bin list
+    // instead of the FFT's bins.
+    AlignedBuffer bandEdges_;
+    AlignedArray<size_t> bandStart_;
+    AlignedArray<size_t> bandBins_;
+    AlignedBuffer bandWeights_;
+    size_t numSlidingBands_;
+    
+    // Per band, in dB: latest measurement, displayed level, held peak and
+    // how long the peak has been held
+    AlignedBuffer measured_;
+    AlignedBuffer level_;
+    AlignedBuffer peak_;
+    AlignedBuffer peakAge_;
+    
+    // Audio thread -> visualization thread sample queue
+    RingBuffer queue_;
+    AlignedBuffer drainBuffer_;
+    std::atomic<size_t> droppedSamples_;
+    size_t droppedFrames_;
     
-    std::vector<float> inputBuffer_;
-    std::vector<float> window_;
-    std::vector<std::complex<float>> fftBuffer_;
-    std::vector<float> magnitude_;
+    TerminalRenderer renderer_;
+    size_t frameHeight_;  // Rows used by the last frame
     
-    // Simple decimation-in-time FFT implementation
-    void fft(std::vector<std::complex<float>>& data);
-    void bitReverse(std::vector<std::complex<float>>& data);
-    size_t bitReversedIndex(size_t index, size_t bits);
+    std::thread thread_;
+    std::atomic<bool> running_;
 };
\ No newline at end of file
@@ -0,0 +1,173 @@
+#include "TerminalRenderer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace {
+const size_t kDefaultRows = 24;
+const size_t kDefaultColumns = 80;
+// Longest cursor escape, "\033[rrrr;cccH", and the longest UTF-8 glyph
+const size_t kMaxEscapeBytes = 12;
+const size_t kMaxGlyphBytes = 4;
+// Unchanged cells shorter than this between two changes are rewritten
+// rather than jumped over; a jump costs 6 to 10 bytes
+const size_t kMaxRewriteGap = 3;
+} // namespace
+
+TerminalRenderer::TerminalRenderer(int fd)
+    : fd_(fd)
+    , rows_(0)
+    , columns_(0)
+    , fullRedraw_(true)
+    , outputLength_(0)
+    , cursorRow_(0)
+    , cursorColumn_(0)
+    , lastFrameBytes_(0)
+    , totalBytes_(0)
+    , frames_(0) {
+    updateSize();
+}
+
+bool TerminalRenderer::updateSize() {
+    size_t rows = kDefaultRows;
+    size_t columns = kDefaultColumns;
+    winsize size;
+    if (ioctl(fd_, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0) {
+        rows = size.ws_row;
+        columns = size.ws_col;
+    }
+    if (rows == rows_ && columns == columns_) return false;
+    
+    rows_ = rows;
+    columns_ = columns;
+    allocate();
+    return true;
+}
+
+void TerminalRenderer::allocate() {
+    next_.assign(rows_ * columns_, U' ');
+    current_.assign(rows_ * columns_, U' ');
+    // Every cell changed, plus a jump per row and the clear/cursor escapes
+    output_.resize(rows_ * (columns_ * kMaxGlyphBytes + kMaxEscapeBytes) + 32);
+    fullRedraw_ = true;
+}
+
+void TerminalRenderer::clear() {
+    std::fill(next_.begin(), next_.end(), U' ');
+}
+
+void TerminalRenderer::put(size_t row, size_t column, char32_t glyph) {
+    if (row < rows_ && column < columns_) {
+        next_[row * columns_ + column] = glyph;
+    }
+}
+
+void TerminalRenderer::print(size_t row, size_t column, const char* text) {
+    for (; *text != '\0'; ++text, ++column) {
+        put(row, column, static_cast<unsigned char>(*text));
+    }
+}
+
+void TerminalRenderer::append(const char* text, size_t length) {
+    std::memcpy(output_.data() + outputLength_, text, length);
+    outputLength_ += length;
+}
+
+void TerminalRenderer::appendGlyph(char32_t glyph) {
+    char* out = output_.data() + outputLength_;
+    if (glyph < 0x80) {
+        out[0] = static_cast<char>(glyph);
+        outputLength_ += 1;
+    } else if (glyph < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (glyph >> 6));
+        out[1] = static_cast<char>(0x80 | (glyph & 0x3F));
+        outputLength_ += 2;
+    } else if (glyph < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (glyph >> 12));
+        out[1] = static_cast<char>(0x80 | ((glyph >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (glyph & 0x3F));
+        outputLength_ += 3;
+    } else {
+        out[0] = static_cast<char>(0xF0 | (glyph >> 18));
+        out[1] = static_cast<char>(0x80 | ((glyph >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((glyph >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (glyph & 0x3F));
+        outputLength_ += 4;
+    }
+}
+
+void TerminalRenderer::moveTo(size_t row, size_t column) {
+    char escape[kMaxEscapeBytes + 8];
+    int length = std::snprintf(escape, sizeof(escape), "\033[%zu;%zuH", row + 1, column + 1);
+    append(escape, static_cast<size_t>(length));
+    cursorRow_ = row;
+    cursorColumn_ = column;
+}
+
+size_t TerminalRenderer::present() {
+    outputLength_ = 0;
+    if (fullRedraw_) {
+        // Hide the cursor, clear, and start from a blank screen
+        const char reset[] = "\033[?25l\033[2J\033[H";
+        append(reset, sizeof(reset) - 1);
+        std::fill(current_.begin(), current_.end(), U' ');
+        cursorRow_ = 0;
+        cursorColumn_ = 0;
+        fullRedraw_ = false;
+    }
+    
+    for (size_t row = 0; row < rows_; ++row) {
+        const char32_t* next = next_.data() + row * columns_;
+        char32_t* current = current_.data() + row * columns_;
+        for (size_t column = 0; column < columns_; ++column) {
+            if (next[column] == current[column]) continue;
+            
+            // Close a short gap on the same row by rewriting it
+            bool nearby = row == cursorRow_ && column >= cursorColumn_ &&
+                          column - cursorColumn_ <= kMaxRewriteGap;
+            if (nearby) {
+                for (size_t gap = cursorColumn_; gap < column; ++gap) {
+                    appendGlyph(current[gap]);
+                }
+            } else {
+                moveTo(row, column);
+            }
+            appendGlyph(next[column]);
+            current[column] = next[column];
+            cursorRow_ = row;
+            cursorColumn_ = column + 1;
+        }
+    }
+    
+    flush();
+    lastFrameBytes_ = outputLength_;
+    totalBytes_ += outputLength_;
+    ++frames_;
+    return outputLength_;
+}
+
+void TerminalRenderer::finish(size_t row) {
+    outputLength_ = 0;
+    moveTo(std::min(row, rows_ - 1), 0);
+    const char show[] = "\033[?25h";
+    append(show, sizeof(show) - 1);
+    flush();
+}
+
+void TerminalRenderer::flush() {
+    // One write() per frame; loop only if the terminal takes part of it
+    const char* data = output_.data();
+    size_t remaining = outputLength_;
+    while (remaining > 0) {
+        ssize_t written = ::write(fd_, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+#include "AlignedBuffer.h"
+#include <cstddef>
+#include <cstdint>
+
+// Frame-buffered full-screen terminal output. A frame is composed into a
+// grid of cells, then present() compares it with what is already on screen
+// and sends only the changed cells, with cursor-positioning escapes between
+// them, in a single write(). The grid follows the terminal size (TIOCGWINSZ);
+// a resize clears the screen and redraws everything. Cells are assumed to be
+// one column wide.
+class TerminalRenderer {
+public:
+    explicit TerminalRenderer(int fd);
+    
+    // Re-reads the terminal size, keeping 24x80 when fd isn't a terminal.
+    // Returns true if it changed.
+    bool updateSize();
+    size_t getRows() const { return rows_; }
+    size_t getColumns() const { return columns_; }
+    
+    // Composing: out-of-range cells are ignored, so callers can clip freely
+    void clear();
+    void put(size_t row, size_t column, char32_t glyph);
+    void print(size_t row, size_t column, const char* text);  // ASCII only
+    
+    // Sends the changes since the last frame, returns the bytes written
+    size_t present();
+    // Moves the cursor to the start of row and shows it again
+    void finish(size_t row);
+    
+    size_t getLastFrameBytes() const { return lastFrameBytes_; }
+    size_t getAverageFrameBytes() const { return frames_ > 0 ? totalBytes_ / frames_ : 0; }
+    
+private:
+    void allocate();
+    void append(const char* text, size_t length);
+    void appendGlyph(char32_t glyph);
+    void moveTo(size_t row, size_t column);
+    void flush();
+    
+    int fd_;
+    size_t rows_;
+    size_t columns_;
+    bool fullRedraw_;
+    
+    AlignedArray<char32_t> next_;     // Frame being composed
+    AlignedArray<char32_t> current_;  // What the terminal shows
+    AlignedArray<char> output_;       // Worst case for one full frame
+    size_t outputLength_;
+    size_t cursorRow_;
+    size_t cursorColumn_;
+    
+    size_t lastFrameBytes_;
+    uint64_t totalBytes_;
+    uint64_t frames_;
+};
\ No newline at end of file
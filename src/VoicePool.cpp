@@ -0,0 +1,168 @@
+#include "VoicePool.h"
+#include <algorithm>
+#include <chrono>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+VoicePool::VoicePool(size_t numVoices, size_t blockSize, float sampleRate,
+                     size_t numWorkers, bool pinWorkers)
+    : blockSize_(blockSize)
+    , sampleRate_(sampleRate)
+    , generation_(0)
+    , shutdown_(false)
+    , activeWorkers_(0)
+    , currentNumSamples_(0)
+    , pinnedWorkers_(0)
+    , blocksProcessed_(0)
+    , deadlineMisses_(0)
+    , lastBlockSeconds_(0.0)
+    , maxBlockSeconds_(0.0) {
+    
+    // The CPUs this process may run on need not be 0..N-1 (taskset, cgroup
+    // cpusets), so workers are mapped onto the allowed set, not an index range
+    std::vector<size_t> cpus = allowedCpus();
+    if (numWorkers == 0) {
+        numWorkers = cpus.size();
+    }
+    numWorkers = std::max<size_t>(1, std::min(numWorkers, numVoices));
+    
+    for (size_t v = 0; v < numVoices; ++v) {
+        voices_.push_back(std::make_unique<PitchShifter>(blockSize, sampleRate));
+    }
+    inputs_.resize(numVoices * blockSize);
+    outputs_.resize(numVoices * blockSize);
+    
+    cursors_ = std::vector<Cursor>(numWorkers);
+    for (Cursor& cursor : cursors_) {
+        cursor.next.store(0, std::memory_order_relaxed);
+        cursor.end = 0;
+    }
+    
+    // Worker 0 is the thread calling processBlock; it keeps whatever core the
+    // caller chose, and helpers are pinned to the allowed cores after it
+    for (size_t w = 1; w < numWorkers; ++w) {
+        threads_.emplace_back(&VoicePool::workerLoop, this, w);
+        if (pinWorkers && !cpus.empty()
+            && pinToCore(threads_.back().native_handle(), cpus[w % cpus.size()])) {
+            ++pinnedWorkers_;
+        }
+    }
+}
+
+VoicePool::~VoicePool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+std::vector<size_t> VoicePool::allowedCpus() {
+    std::vector<size_t> cpus;
+#ifdef __linux__
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        // Unknown mask: size the pool by the core count and leave it unpinned
+        size_t numCores = std::max(1u, std::thread::hardware_concurrency());
+        return std::vector<size_t>(numCores, kUnpinned);
+    }
+    return cpus;
+}
+
+bool VoicePool::pinToCore(std::thread::native_handle_type thread, size_t core) {
+#ifdef __linux__
+    if (core == kUnpinned) {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    return pthread_setaffinity_np(thread, sizeof(cpus), &cpus) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+bool VoicePool::processBlock(size_t numSamples) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    
+    numSamples = std::min(numSamples, blockSize_);
+    size_t numVoices = voices_.size();
+    size_t numWorkers = cursors_.size();
+    
+    // Give each worker an even, contiguous share of the voices
+    for (size_t w = 0; w < numWorkers; ++w) {
+        cursors_[w].next.store(numVoices * w / numWorkers, std::memory_order_relaxed);
+        cursors_[w].end = numVoices * (w + 1) / numWorkers;
+    }
+    activeWorkers_.store(numWorkers - 1, std::memory_order_relaxed);
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        currentNumSamples_ = numSamples;
+        ++generation_;
+    }
+    wake_.notify_all();
+    
+    runWorker(0);
+    while (activeWorkers_.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+    
+    lastBlockSeconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+    maxBlockSeconds_ = std::max(maxBlockSeconds_, lastBlockSeconds_);
+    blocksProcessed_++;
+    
+    bool onTime = lastBlockSeconds_ <= numSamples / sampleRate_;
+    if (!onTime) {
+        deadlineMisses_++;
+    }
+    return onTime;
+}
+
+void VoicePool::workerLoop(size_t worker) {
+    size_t seenGeneration = 0;
+    
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return shutdown_ || generation_ != seenGeneration; });
+            if (shutdown_) return;
+            seenGeneration = generation_;
+        }
+        
+        runWorker(worker);
+        activeWorkers_.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+void VoicePool::runWorker(size_t worker) {
+    size_t numWorkers = cursors_.size();
+    
+    // Drain our own range first, then steal from the other workers' ranges
+    for (size_t k = 0; k < numWorkers; ++k) {
+        Cursor& cursor = cursors_[(worker + k) % numWorkers];
+        for (;;) {
+            size_t v = cursor.next.fetch_add(1, std::memory_order_relaxed);
+            if (v >= cursor.end) break;
+            voices_[v]->processBlock(getInput(v), getOutput(v), currentNumSamples_);
+        }
+    }
+}
\ No newline at end of file
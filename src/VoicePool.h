@@ -0,0 +1,76 @@
+#pragma once
+#include "PitchShifter.h"
+#include "AlignedBuffer.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Owns many independent mono PitchShifter voices (e.g. one per call leg) and
+// processes one block of all of them across a fixed worker pool. Each worker
+// starts on its own contiguous range of voices and steals from the others'
+// ranges once it runs dry. The calling thread takes part as worker 0.
+class VoicePool {
+public:
+    // numWorkers == 0 uses every hardware thread
+    VoicePool(size_t numVoices, size_t blockSize, float sampleRate,
+              size_t numWorkers = 0, bool pinWorkers = true);
+    ~VoicePool();
+    
+    PitchShifter& getVoice(size_t index) { return *voices_[index]; }
+    float* getInput(size_t voice) { return inputs_.data() + voice * blockSize_; }
+    float* getOutput(size_t voice) { return outputs_.data() + voice * blockSize_; }
+    
+    // Processes numSamples (<= blockSize) for every voice and returns once all
+    // are done. Returns false if the block took longer than its real duration.
+    bool processBlock(size_t numSamples);
+    
+    size_t getNumVoices() const { return voices_.size(); }
+    size_t getNumWorkers() const { return cursors_.size(); }
+    // Helper workers whose affinity was actually set (at most workers - 1)
+    size_t getNumPinnedWorkers() const { return pinnedWorkers_; }
+    size_t getBlocksProcessed() const { return blocksProcessed_; }
+    size_t getDeadlineMisses() const { return deadlineMisses_; }
+    double getLastBlockSeconds() const { return lastBlockSeconds_; }
+    double getMaxBlockSeconds() const { return maxBlockSeconds_; }
+    
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kUnpinned = static_cast<size_t>(-1);
+    
+    // One range of voice indices per worker, on its own cache line
+    struct alignas(kCacheLineSize) Cursor {
+        std::atomic<size_t> next;
+        size_t end;
+    };
+    
+    void workerLoop(size_t worker);
+    void runWorker(size_t worker);
+    static std::vector<size_t> allowedCpus();
+    static bool pinToCore(std::thread::native_handle_type thread, size_t core);
+    
+    std::vector<std::unique_ptr<PitchShifter>> voices_;
+    size_t blockSize_;
+    float sampleRate_;
+    AlignedBuffer inputs_;
+    AlignedBuffer outputs_;
+    
+    std::vector<Cursor> cursors_;
+    std::vector<std::thread> threads_;
+    
+    // Block dispatch: workers wait for a new generation, then count down
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    size_t generation_;
+    bool shutdown_;
+    std::atomic<size_t> activeWorkers_;
+    size_t currentNumSamples_;
+    size_t pinnedWorkers_;
+    
+    size_t blocksProcessed_;
+    size_t deadlineMisses_;
+    double lastBlockSeconds_;
+    double maxBlockSeconds_;
+};
\ No newline at end of file
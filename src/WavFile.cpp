@@ -0,0 +1,264 @@
+#include "WavFile.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+uint16_t readLE16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void writeLE16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLE32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+const uint16_t kFormatPCM = 1;
+const uint16_t kFormatFloat = 3;
+const uint16_t kFormatExtensible = 0xFFFE;
+const size_t kHeaderSize = 44;
+// The RIFF size field counts the header after itself plus the data, in 32 bits
+const uint64_t kMaxDataBytes = UINT32_MAX - (kHeaderSize - 8);
+
+} // namespace
+
+WavReader::WavReader()
+    : file_(nullptr)
+    , sampleRate_(0)
+    , channels_(0)
+    , bitsPerSample_(0)
+    , isFloat_(false)
+    , totalFrames_(0)
+    , framesRemaining_(0) {
+}
+
+WavReader::~WavReader() {
+    close();
+}
+
+bool WavReader::fail(const std::string& message) {
+    error_ = message;
+    close();
+    return false;
+}
+
+bool WavReader::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        return fail("Cannot open " + path);
+    }
+
+    uint8_t riff[12];
+    if (std::fread(riff, 1, sizeof(riff), file_) != sizeof(riff) ||
+        std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return fail(path + " is not a RIFF/WAVE file");
+    }
+
+    bool haveFormat = false;
+    uint16_t format = 0;
+    uint16_t blockAlign = 0;
+
+    // Walk chunks until the data chunk; fmt must precede it
+    uint8_t chunkHeader[8];
+    while (std::fread(chunkHeader, 1, sizeof(chunkHeader), file_) == sizeof(chunkHeader)) {
+        uint32_t chunkSize = readLE32(chunkHeader + 4);
+
+        if (std::memcmp(chunkHeader, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {};
+            size_t toRead = std::min<size_t>(chunkSize, sizeof(fmt));
+            if (chunkSize < 16 || std::fread(fmt, 1, toRead, file_) != toRead) {
+                return fail("Malformed fmt chunk in " + path);
+            }
+            format = readLE16(fmt);
+            channels_ = readLE16(fmt + 2);
+            sampleRate_ = readLE32(fmt + 4);
+            blockAlign = readLE16(fmt + 12);
+            bitsPerSample_ = readLE16(fmt + 14);
+            if (format == kFormatExtensible && chunkSize >= 26) {
+                format = readLE16(fmt + 24);  // Sub-format GUID starts with the format tag
+            }
+            if (std::fseek(file_, static_cast<long>(chunkSize - toRead + (chunkSize & 1)), SEEK_CUR) != 0) {
+                return fail("Malformed fmt chunk in " + path);
+            }
+            haveFormat = true;
+        } else if (std::memcmp(chunkHeader, "data", 4) == 0) {
+            if (!haveFormat) {
+                return fail("Missing fmt chunk in " + path);
+            }
+            if (format == kFormatFloat && bitsPerSample_ == 32) {
+                isFloat_ = true;
+            } else if (format == kFormatPCM &&
+                       (bitsPerSample_ == 16 || bitsPerSample_ == 24 || bitsPerSample_ == 32)) {
+                isFloat_ = false;
+            } else {
+                return fail("Unsupported WAV sample format in " + path);
+            }
+            if (channels_ == 0 || blockAlign != channels_ * (bitsPerSample_ / 8)) {
+                return fail("Invalid channel layout in " + path);
+            }
+            totalFrames_ = chunkSize / blockAlign;
+            framesRemaining_ = totalFrames_;
+            return true;
+        } else {
+            if (std::fseek(file_, static_cast<long>(chunkSize + (chunkSize & 1)), SEEK_CUR) != 0) {
+                break;
+            }
+        }
+    }
+
+    return fail("No data chunk in " + path);
+}
+
+void WavReader::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    framesRemaining_ = 0;
+}
+
+size_t WavReader::read(float* data, size_t numFrames) {
+    if (!file_ || !data || numFrames == 0) return 0;
+
+    size_t bytesPerSample = bitsPerSample_ / 8;
+    size_t frameBytes = bytesPerSample * channels_;
+    numFrames = std::min(numFrames, framesRemaining_);
+    rawBuffer_.resize(numFrames * frameBytes);
+
+    size_t framesRead = std::fread(rawBuffer_.data(), frameBytes, numFrames, file_);
+    framesRemaining_ -= framesRead;
+
+    const uint8_t* src = rawBuffer_.data();
+    size_t numSamples = framesRead * channels_;
+    for (size_t i = 0; i < numSamples; ++i, src += bytesPerSample) {
+        if (isFloat_) {
+            uint32_t bits = readLE32(src);
+            std::memcpy(&data[i], &bits, sizeof(float));
+        } else if (bytesPerSample == 2) {
+            data[i] = static_cast<int16_t>(readLE16(src)) / 32768.0f;
+        } else if (bytesPerSample == 3) {
+            // Place the 24-bit value in the top bytes and shift back to sign-extend
+            int32_t value = static_cast<int32_t>((static_cast<uint32_t>(src[0]) << 8) |
+                                         (static_cast<uint32_t>(src[1]) << 16) |
+                                         (static_cast<uint32_t>(src[2]) << 24)) >> 8;
+            data[i] = value / 8388608.0f;
+        } else {
+            data[i] = static_cast<int32_t>(readLE32(src)) / 2147483648.0f;
+        }
+    }
+
+    return framesRead;
+}
+
+WavWriter::WavWriter()
+    : file_(nullptr)
+    , sampleRate_(0)
+    , channels_(0)
+    , framesWritten_(0) {
+}
+
+WavWriter::~WavWriter() {
+    close();
+}
+
+bool WavWriter::open(const std::string& path, unsigned int sampleRate, unsigned int channels) {
+    close();
+    error_.clear();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        error_ = "Cannot create " + path;
+        return false;
+    }
+    path_ = path;
+    sampleRate_ = sampleRate;
+    channels_ = channels;
+    framesWritten_ = 0;
+    if (!writeHeader()) {  // Placeholder sizes, patched in close()
+        return fail("Cannot write " + path_);
+    }
+    return true;
+}
+
+// Records the error with the OS reason and abandons the file
+bool WavWriter::fail(const std::string& message) {
+    error_ = message + ": " + std::strerror(errno);
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    return false;
+}
+
+bool WavWriter::writeHeader() {
+    uint32_t dataBytes = static_cast<uint32_t>(framesWritten_ * channels_ * sizeof(float));
+    uint8_t header[kHeaderSize];
+    std::memcpy(header, "RIFF", 4);
+    writeLE32(header + 4, static_cast<uint32_t>(kHeaderSize - 8) + dataBytes);
+    std::memcpy(header + 8, "WAVE", 4);
+    std::memcpy(header + 12, "fmt ", 4);
+    writeLE32(header + 16, 16);
+    writeLE16(header + 20, kFormatFloat);
+    writeLE16(header + 22, static_cast<uint16_t>(channels_));
+    writeLE32(header + 24, sampleRate_);
+    writeLE32(header + 28, static_cast<uint32_t>(sampleRate_ * channels_ * sizeof(float)));
+    writeLE16(header + 32, static_cast<uint16_t>(channels_ * sizeof(float)));
+    writeLE16(header + 34, 32);
+    std::memcpy(header + 36, "data", 4);
+    writeLE32(header + 40, dataBytes);
+    return std::fwrite(header, 1, sizeof(header), file_) == sizeof(header);
+}
+
+bool WavWriter::write(const float* data, size_t numFrames) {
+    if (!file_) return false;
+    if (!data || numFrames == 0) return true;
+    uint64_t dataBytes = (static_cast<uint64_t>(framesWritten_) + numFrames) * channels_ * sizeof(float);
+    if (dataBytes > kMaxDataBytes) {
+        // Leave the file open so close() still finishes what fits
+        error_ = "Cannot write " + path_ + ": WAV files are limited to 4 GiB";
+        return false;
+    }
+
+    uint8_t encoded[4 * 256];
+    size_t numSamples = numFrames * channels_;
+    for (size_t offset = 0; offset < numSamples; offset += 256) {
+        size_t chunk = std::min<size_t>(256, numSamples - offset);
+        for (size_t i = 0; i < chunk; ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &data[offset + i], sizeof(float));
+            writeLE32(encoded + i * 4, bits);
+        }
+        if (std::fwrite(encoded, 4, chunk, file_) != chunk) {
+            return fail("Cannot write " + path_);
+        }
+    }
+    framesWritten_ += numFrames;
+    return true;
+}
+
+bool WavWriter::close() {
+    if (!file_) return error_.empty();
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || !writeHeader()) {
+        return fail("Cannot finish " + path_);
+    }
+    int result = std::fclose(file_);
+    file_ = nullptr;
+    if (result != 0) {
+        error_ = "Cannot finish " + path_ + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
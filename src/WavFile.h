@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Streaming RIFF/WAVE reader. Supports 16/24/32-bit PCM and 32-bit float,
+// delivering interleaved float samples in [-1, 1].
+class WavReader {
+public:
+    WavReader();
+    ~WavReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Reads up to numFrames interleaved frames, returns frames actually read
+    size_t read(float* data, size_t numFrames);
+
+    unsigned int getSampleRate() const { return sampleRate_; }
+    unsigned int getChannels() const { return channels_; }
+    size_t getTotalFrames() const { return totalFrames_; }
+    const std::string& getError() const { return error_; }
+
+private:
+    bool fail(const std::string& message);
+
+    FILE* file_;
+    unsigned int sampleRate_;
+    unsigned int channels_;
+    unsigned int bitsPerSample_;
+    bool isFloat_;
+    size_t totalFrames_;
+    size_t framesRemaining_;
+    std::vector<uint8_t> rawBuffer_;
+    std::string error_;
+};
+
+// Streaming WAV writer producing 32-bit float files. The header sizes are
+// patched on close(), so output can be written block by block. write() and
+// close() return false on an I/O error (e.g. a full disk), with getError()
+// set; the file is then incomplete. write() also refuses frames that would
+// take the data past the format's 4 GiB limit; close() then finishes a valid
+// file holding what was written before.
+class WavWriter {
+public:
+    WavWriter();
+    ~WavWriter();
+
+    bool open(const std::string& path, unsigned int sampleRate, unsigned int channels);
+    bool write(const float* data, size_t numFrames);
+    bool close();
+
+    size_t getFramesWritten() const { return framesWritten_; }
+    const std::string& getError() const { return error_; }
+
+private:
+    bool writeHeader();
+    bool fail(const std::string& message);
+
+    FILE* file_;
+    std::string path_;
+    unsigned int sampleRate_;
+    unsigned int channels_;
+    size_t framesWritten_;
+    std::string error_;
+};
\ No newline at end of file
@@ -3,12 +3,37 @@
 #include <cstring>
 #include <cmath>
 #include <cstdlib>
+#include <csignal>
+#include <unistd.h>
+#include <chrono>
+#include <memory>
+#include <vector>
 #include "RingBuffer.h"
+#include "PitchEngine.h"
 #include "PitchShifter.h"
+#include "PhaseVocoder.h"
+#include "PitchProcessor.h"
+#include "Scale.h"
 #include "SpectralMeter.h"
+#include "WavFile.h"
+#include "PcmPipe.h"
+#include "ParameterMailbox.h"
+#include "SmoothedValue.h"
+#include "ControlInput.h"
+#include "CallbackStats.h"
+#include "AudioCallback.h"
+#include "Arena.h"
+#include "ArenaPtr.h"
+#include "RealtimeGuard.h"
+#include "RealtimeSetup.h"
 
 #define POCKET_PITCH_VERSION "1.0.0"
 
+// Frames per read/write in --pipe mode, rounded up to whole --buffer blocks
+const size_t kPipeBlockFrames = 16384;
+// How long the --realtime report waits for the first callback
+const std::chrono::milliseconds kRealtimeReportWait(500);
+
 void printUsage(const char* programName) {
     std::cout << "Usage: " << programName << " [options]\n"
               << "Options:\n"
@@ -16,7 +41,34 @@ void printUsage(const char* programName) {
               << "  -m, --mix <value>         Wet/dry mix [0.0 to 1.0] (default: 1.0)\n"
               << "  -g, --gain <value>        Output gain [0.1 to 2.0] (default: 1.0)\n"
               << "  -p, --preset <name>       Use preset (octave-up, octave-down, fifth-up, chipmunk, deep)\n"
+              << "  -r, --rate <hz>           Sample rate, 8000 to 192000 (default: 44100)\n"
+              << "  -b, --buffer <frames>     Frames per period, 16 to 8192 (default: 256)\n"
+              << "  -e, --engine <name>       Shifting engine: granular, vocoder (default: granular)\n"
+              << "      --grain <ms>          Grain length in milliseconds, 2 to 100 (default: 23.2)\n"
+              << "      --low-latency         Short grains and minimal device buffering (granular only)\n"
+              << "      --align-dry           Delay the dry signal to match the shifted one, so partial\n"
+              << "                            mixes don't comb filter (adds the engine's latency to it)\n"
+              << "      --preserve-formants   Keep the input's formants so shifted voices keep their\n"
+              << "                            character instead of sounding cartoonish\n"
+              << "      --track-pitch         Track the input pitch and align grains to its period\n"
+              << "      --scale <name>        Snap the shifted pitch to a scale: chromatic, <key>-major,\n"
+              << "                            <key>-minor, e.g. a-minor (implies --track-pitch)\n"
+              << "  -c, --channels <n>        Input/output channels, 1 to 32 (default: 1)\n"
               << "  -f, --fft                 Enable spectral meter visualization\n"
+              << "      --fft-size <n>        Spectral meter FFT size, power of two (default: 1024)\n"
+              << "      --fft-hop <n>         Samples between meter analyses (default: FFT size / 4)\n"
+              << "      --sliding-dft         Resolve the low meter bands with a sliding DFT 8x longer\n"
+              << "                            than the FFT\n"
+              << "  -w, --window <shape>      Granular window: hann, tukey, blackman (default: hann)\n"
+              << "  -i, --input <file.wav>    Render a WAV file offline instead of using audio devices\n"
+              << "  -o, --output <file.wav>   Destination for offline rendering (32-bit float WAV)\n"
+              << "      --pipe <f32|s16>      Filter raw little-endian PCM from stdin to stdout at\n"
+              << "                            --rate and --channels; messages go to stderr\n"
+              << "      --stats               Print callback timing and xrun statistics every second\n"
+              << "      --stats-file <path>   Keep callback statistics as JSON in a file\n"
+              << "      --realtime            Real-time scheduling for the audio thread, locked memory\n"
+              << "                            and a CPU of its own; reports what was granted\n"
+              << "      --rt-priority <n>     Audio thread priority, 1 to 99 (default: 70, implies --realtime)\n"
               << "  -v, --version             Show version information\n"
               << "  -h, --help                Show this help message\n"
               << "\nPresets:\n"
@@ -27,51 +79,251 @@ void printUsage(const char* programName) {
               << "  deep         -5 semitones (lower voice)\n"
               << "\nExamples:\n"
               << "  " << programName << " -p chipmunk -m 0.8   # Chipmunk preset with 80% mix\n"
-              << "  " << programName << " -s 7 -m 0.5 -g 1.5   # +7 semitones, 50% mix, +3dB gain\n";
+              << "  " << programName << " -s 7 -m 0.5 -g 1.5   # +7 semitones, 50% mix, +3dB gain\n"
+              << "  " << programName << " -i take.wav -o out.wav -p deep   # Offline render\n"
+              << "  " << programName << " -p chipmunk --preserve-formants   # Higher, not cartoonish\n"
+              << "  ffmpeg -i in.mp3 -f s16le -ac 2 -ar 44100 - | " << programName
+              << " --pipe s16 -c 2 -s 3 | lame -r - out.mp3\n"
+              << "  " << programName << " -p octave-up -e vocoder   # Phase vocoder engine\n"
+              << "  " << programName << " -s 0 --scale c-major   # Auto-tune to C major\n";
 }
 
-struct AudioData {
-    PitchShifter* pitchShifter;
-    SpectralMeter* spectralMeter;
-    unsigned int bufferSize;
-    float pitchSemitones;
-    float outputGain;
-    bool enableFFT;
-    bool usingPreset;
-    const char* presetName;
+struct Options {
+    float semitones = 5.0f;   // Default to +5 semitones
+    float mixLevel = 1.0f;    // Default to 100% wet
+    float outputGain = 1.0f;  // Default to unity gain
+    bool enableFFT = false;   // Default to no FFT display
+    size_t fftSize = 1024;
+    size_t fftHop = 0;  // 0 = fftSize / 4
+    MeterAnalysis meterAnalysis = MeterAnalysis::FFT;
+    unsigned int numChannels = 1;
+    unsigned int sampleRate = 44100;
+    unsigned int bufferFrames = 256;
+    EngineType engine = EngineType::Granular;
+    float grainMs = PitchShifter::kDefaultGrainMs;
+    WindowShape windowShape = WindowShape::Hann;
+    bool lowLatency = false;
+    bool compensateDry = false;
+    bool preserveFormants = false;
+    bool trackPitch = false;
+    bool snapToScale = false;
+    Scale scale;
+    const char* scaleName = nullptr;
+    bool usingPreset = false;
+    const char* presetName = nullptr;
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    bool pipe = false;
+    PcmFormat pipeFormat = PcmFormat::Float32;
+    bool printStats = false;
+    const char* statsPath = nullptr;
+    bool realtime = false;
+    int realtimePriority = RealtimeSetup::kDefaultPriority;
 };
 
 int audioCallback(void* outputBuffer, void* inputBuffer, unsigned int nBufferFrames,
                  double /*streamTime*/, RtAudioStreamStatus status, void* userData) {
+    AudioData& data = *static_cast<AudioData*>(userData);
+    if (data.realtime) {
+        data.realtime->recordAudioThread();
+    }
+    processAudioCallback(data, static_cast<const float*>(inputBuffer),
+                         static_cast<float*>(outputBuffer), nBufferFrames,
+                         (status & RTAUDIO_INPUT_OVERFLOW) != 0, (status & RTAUDIO_OUTPUT_UNDERFLOW) != 0);
+    return 0;
+}
+
+const char* getEngineName(EngineType type) {
+    return type == EngineType::PhaseVocoder ? "vocoder" : "granular";
+}
+
+// Maps the command line onto the DSP library's configuration
+PitchProcessorConfig makeProcessorConfig(const Options& options, unsigned int sampleRate, unsigned int channels) {
+    PitchProcessorConfig config;
+    config.engine = options.engine;
+    config.sampleRate = static_cast<float>(sampleRate);
+    config.numChannels = channels;
+    config.grainMs = options.grainMs;
+    config.windowShape = options.windowShape;
+    config.semitones = options.semitones;
+    config.mixLevel = options.mixLevel;
+    config.outputGain = options.outputGain;
+    config.trackPitch = options.trackPitch;
+    config.snapToScale = options.snapToScale;
+    config.scale = options.scale;
+    config.compensateDry = options.compensateDry;
+    config.preserveFormants = options.preserveFormants;
+    return config;
+}
+
+// Builds the spectral meter with its buffers carved from arena
+ArenaPtr<SpectralMeter> buildMeter(Arena* arena, const Options& options, unsigned int sampleRate) {
+    Arena::Scope scope(arena);
+    return makeArenaObject<SpectralMeter>(options.fftSize, static_cast<float>(sampleRate), options.fftHop,
+                                          options.meterAnalysis);
+}
+
+// Arena capacity the meter needs, from a dry run the same way the processor
+// sizes its own
+size_t measureMeter(const Options& options, unsigned int sampleRate) {
+    Arena sizing(0);
+    buildMeter(&sizing, options, sampleRate);
+    return sizing.getOverflow();
+}
+
+// Total input-to-output latency: the device's buffering plus the engine's
+// algorithmic delay. APIs that don't report stream latency are assumed to
+// buffer one input and one output period.
+void printLatency(long streamLatency, unsigned int bufferFrames, size_t algorithmSamples,
+                  unsigned int sampleRate) {
+    bool reported = streamLatency > 0;
+    size_t deviceSamples = reported ? static_cast<size_t>(streamLatency) : 2 * static_cast<size_t>(bufferFrames);
+    double msPerSample = 1000.0 / sampleRate;
+    std::cout << "Latency: " << ((deviceSamples + algorithmSamples) * msPerSample) << " ms (device "
+              << (reported ? "" : "~") << (deviceSamples * msPerSample) << " ms + algorithm "
+              << (algorithmSamples * msPerSample) << " ms, " << algorithmSamples << " samples)" << std::endl;
+}
+
+// With the real-time guard compiled in, report what the audio path did and
+// fail the run on any violation so CI can enforce it
+int checkRealtimeGuard(int status) {
+    if (!RealtimeGuard::kEnabled) return status;
+    RealtimeGuard::printReport(std::cerr);
+    return RealtimeGuard::getTotalViolations() > 0 ? -1 : status;
+}
+
+// Streams a WAV file through the same PitchProcessor used by the audio
+// callback, as fast as the CPU allows, and reports the realtime factor.
+// The file's own sample rate overrides --rate.
+int renderOffline(const Options& options) {
+    const char* outputPath = options.outputPath;
+    unsigned int bufferFrames = options.bufferFrames;
     
-    if (status) {
-        std::cerr << "Stream underflow/overflow detected!" << std::endl;
+    WavReader reader;
+    if (!reader.open(options.inputPath)) {
+        std::cerr << reader.getError() << std::endl;
+        return -1;
     }
     
-    AudioData* data = static_cast<AudioData*>(userData);
-    float* input = static_cast<float*>(inputBuffer);
-    float* output = static_cast<float*>(outputBuffer);
+    WavWriter writer;
+    if (!writer.open(outputPath, reader.getSampleRate(), reader.getChannels())) {
+        std::cerr << writer.getError() << std::endl;
+        return -1;
+    }
     
-    // Process audio through pitch shifter
-    if (input && output && data->pitchShifter) {
-        data->pitchShifter->processBlock(input, output, nBufferFrames);
-        
-        // Apply output gain
-        for (unsigned int i = 0; i < nBufferFrames; ++i) {
-            output[i] *= data->outputGain;
+    unsigned int channels = reader.getChannels();
+    unsigned int sampleRate = reader.getSampleRate();
+    
+    PitchProcessor processor(makeProcessorConfig(options, sampleRate, channels));
+    
+    std::vector<float> frames(bufferFrames * channels);
+    
+    using Clock = std::chrono::steady_clock;
+    Clock::duration dspTime = Clock::duration::zero();
+    auto wallStart = Clock::now();
+    
+    size_t totalFrames = 0;
+    size_t framesRead;
+    while ((framesRead = reader.read(frames.data(), bufferFrames)) > 0) {
+        auto blockStart = Clock::now();
+        {
+            // Same real-time rules as the audio callback
+            RealtimeGuard guard;
+            processor.processInterleaved(frames.data(), frames.data(), framesRead);
         }
+        dspTime += Clock::now() - blockStart;
         
-        // Feed output to spectral meter if enabled
-        if (data->enableFFT && data->spectralMeter) {
-            for (unsigned int i = 0; i < nBufferFrames; ++i) {
-                data->spectralMeter->addSample(output[i]);
-            }
+        if (!writer.write(frames.data(), framesRead)) {
+            std::cerr << writer.getError() << std::endl;
+            return -1;
         }
-    } else {
-        // Fill with silence if no input/output buffers
-        if (output) {
-            std::memset(output, 0, nBufferFrames * sizeof(float));
+        totalFrames += framesRead;
+    }
+    
+    if (!writer.close()) {
+        std::cerr << writer.getError() << std::endl;
+        return -1;
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    double dspSeconds = std::chrono::duration<double>(dspTime).count();
+    double audioSeconds = static_cast<double>(totalFrames) / sampleRate;
+    
+    std::cout << "Rendered " << totalFrames << " frames x " << channels << " channels ("
+              << audioSeconds << " s at " << sampleRate << " Hz) to " << outputPath << std::endl;
+    std::cout << "Latency: " << processor.getLatencySamples() << " samples ("
+              << (1000.0 * processor.getLatencySamples() / sampleRate) << " ms)"
+              << (options.compensateDry ? ", dry aligned" : "") << std::endl;
+    if (dspSeconds > 0.0) {
+        std::cout << "DSP: " << dspSeconds << " s, " << (totalFrames / dspSeconds)
+                  << " frames/sec, " << (audioSeconds / dspSeconds) << "x realtime" << std::endl;
+    }
+    if (wallSeconds > 0.0) {
+        std::cout << "Total (including file I/O): " << wallSeconds << " s, "
+                  << (audioSeconds / wallSeconds) << "x realtime" << std::endl;
+    }
+    
+    return 0;
+}
+
+// Unix filter mode: raw PCM from stdin through the DSP to stdout. The pipe's
+// threads read and write ahead while this thread processes in --buffer
+// sized steps, so output matches a WAV render of the same audio. Nothing but
+// audio may reach stdout, so the report goes to stderr.
+int renderPipe(const Options& options) {
+    unsigned int channels = options.numChannels;
+    unsigned int sampleRate = options.sampleRate;
+    unsigned int bufferFrames = options.bufferFrames;
+    
+    // Let a closed downstream surface as a write error instead of killing us
+    std::signal(SIGPIPE, SIG_IGN);
+    
+    PitchProcessor processor(makeProcessorConfig(options, sampleRate, channels));
+    
+    // Large I/O blocks, a whole number of processing blocks each
+    size_t pipeFrames = ((kPipeBlockFrames + bufferFrames - 1) / bufferFrames) * bufferFrames;
+    PcmPipe pipe(STDIN_FILENO, STDOUT_FILENO, options.pipeFormat, channels, pipeFrames);
+    
+    using Clock = std::chrono::steady_clock;
+    Clock::duration dspTime = Clock::duration::zero();
+    auto wallStart = Clock::now();
+    pipe.start();
+    
+    size_t totalFrames = 0;
+    float* block;
+    size_t numFrames;
+    while ((numFrames = pipe.acquire(block)) > 0) {
+        auto blockStart = Clock::now();
+        for (size_t offset = 0; offset < numFrames; offset += bufferFrames) {
+            size_t frames = std::min<size_t>(bufferFrames, numFrames - offset);
+            float* frameData = block + offset * channels;
+            
+            // Same real-time rules as the audio callback
+            RealtimeGuard guard;
+            processor.processInterleaved(frameData, frameData, frames);
         }
+        dspTime += Clock::now() - blockStart;
+        pipe.release();
+        totalFrames += numFrames;
+    }
+    
+    if (!pipe.finish()) {
+        std::cerr << pipe.getError() << std::endl;
+        return -1;
+    }
+    
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - wallStart).count();
+    double dspSeconds = std::chrono::duration<double>(dspTime).count();
+    double audioSeconds = static_cast<double>(totalFrames) / sampleRate;
+    std::cerr << "Piped " << totalFrames << " frames x " << channels << " channels (" << audioSeconds
+              << " s at " << sampleRate << " Hz), latency " << processor.getLatencySamples() << " samples"
+              << std::endl;
+    if (dspSeconds > 0.0) {
+        std::cerr << "DSP: " << dspSeconds << " s, " << (audioSeconds / dspSeconds) << "x realtime" << std::endl;
+    }
+    if (wallSeconds > 0.0) {
+        std::cerr << "Total (including pipe I/O): " << wallSeconds << " s, " << (audioSeconds / wallSeconds)
+                  << "x realtime, " << ((pipe.getBytesRead() + pipe.getBytesWritten()) / wallSeconds / 1e6)
+                  << " MB/s" << std::endl;
     }
     
     return 0;
@@ -79,52 +331,167 @@ int audioCallback(void* outputBuffer, void* inputBuffer, unsigned int nBufferFra
 
 int main(int argc, char* argv[]) {
     // Parse command line arguments
-    float semitones = 5.0f;  // Default to +5 semitones
-    float mixLevel = 1.0f;   // Default to 100% wet
-    float outputGain = 1.0f; // Default to unity gain
-    bool enableFFT = false;  // Default to no FFT display
-    bool usingPreset = false;
-    const char* presetName = nullptr;
+    Options options;
     
     for (int i = 1; i < argc; ++i) {
         if (std::strcmp(argv[i], "-s") == 0 || std::strcmp(argv[i], "--semitones") == 0) {
             if (i + 1 < argc) {
-                semitones = std::atof(argv[++i]);
-                semitones = std::max(-12.0f, std::min(12.0f, semitones));
+                options.semitones = std::atof(argv[++i]);
+                options.semitones = std::max(-12.0f, std::min(12.0f, options.semitones));
             }
         } else if (std::strcmp(argv[i], "-m") == 0 || std::strcmp(argv[i], "--mix") == 0) {
             if (i + 1 < argc) {
-                mixLevel = std::atof(argv[++i]);
-                mixLevel = std::max(0.0f, std::min(1.0f, mixLevel));
+                options.mixLevel = std::atof(argv[++i]);
+                options.mixLevel = std::max(0.0f, std::min(1.0f, options.mixLevel));
             }
         } else if (std::strcmp(argv[i], "-g") == 0 || std::strcmp(argv[i], "--gain") == 0) {
             if (i + 1 < argc) {
-                outputGain = std::atof(argv[++i]);
-                outputGain = std::max(0.1f, std::min(2.0f, outputGain));
+                options.outputGain = std::atof(argv[++i]);
+                options.outputGain = std::max(0.1f, std::min(2.0f, options.outputGain));
             }
         } else if (std::strcmp(argv[i], "-p") == 0 || std::strcmp(argv[i], "--preset") == 0) {
             if (i + 1 < argc) {
-                presetName = argv[++i];
-                usingPreset = true;
+                options.presetName = argv[++i];
+                options.usingPreset = true;
                 
-                if (std::strcmp(presetName, "octave-up") == 0) {
-                    semitones = 12.0f;
-                } else if (std::strcmp(presetName, "octave-down") == 0) {
-                    semitones = -12.0f;
-                } else if (std::strcmp(presetName, "fifth-up") == 0) {
-                    semitones = 7.0f;
-                } else if (std::strcmp(presetName, "chipmunk") == 0) {
-                    semitones = 8.0f;
-                } else if (std::strcmp(presetName, "deep") == 0) {
-                    semitones = -5.0f;
+                if (std::strcmp(options.presetName, "octave-up") == 0) {
+                    options.semitones = 12.0f;
+                } else if (std::strcmp(options.presetName, "octave-down") == 0) {
+                    options.semitones = -12.0f;
+                } else if (std::strcmp(options.presetName, "fifth-up") == 0) {
+                    options.semitones = 7.0f;
+                } else if (std::strcmp(options.presetName, "chipmunk") == 0) {
+                    options.semitones = 8.0f;
+                } else if (std::strcmp(options.presetName, "deep") == 0) {
+                    options.semitones = -5.0f;
                 } else {
-                    std::cerr << "Unknown preset: " << presetName << std::endl;
+                    std::cerr << "Unknown preset: " << options.presetName << std::endl;
                     std::cerr << "Available presets: octave-up, octave-down, fifth-up, chipmunk, deep" << std::endl;
                     return -1;
                 }
             }
+        } else if (std::strcmp(argv[i], "-r") == 0 || std::strcmp(argv[i], "--rate") == 0) {
+            if (i + 1 < argc) {
+                options.sampleRate = static_cast<unsigned int>(std::max(8000, std::min(192000, std::atoi(argv[++i]))));
+            }
+        } else if (std::strcmp(argv[i], "-b") == 0 || std::strcmp(argv[i], "--buffer") == 0) {
+            if (i + 1 < argc) {
+                options.bufferFrames = static_cast<unsigned int>(std::max(16, std::min(8192, std::atoi(argv[++i]))));
+            }
+        } else if (std::strcmp(argv[i], "-e") == 0 || std::strcmp(argv[i], "--engine") == 0) {
+            if (i + 1 < argc) {
+                const char* engineName = argv[++i];
+                if (std::strcmp(engineName, "granular") == 0) {
+                    options.engine = EngineType::Granular;
+                } else if (std::strcmp(engineName, "vocoder") == 0) {
+                    options.engine = EngineType::PhaseVocoder;
+                } else {
+                    std::cerr << "Unknown engine: " << engineName << std::endl;
+                    std::cerr << "Available engines: granular, vocoder" << std::endl;
+                    return -1;
+                }
+            }
+        } else if (std::strcmp(argv[i], "--grain") == 0) {
+            if (i + 1 < argc) {
+                options.grainMs = std::atof(argv[++i]);
+                options.grainMs = std::max(2.0f, std::min(100.0f, options.grainMs));
+            }
+        } else if (std::strcmp(argv[i], "--low-latency") == 0) {
+            options.lowLatency = true;
+        } else if (std::strcmp(argv[i], "--align-dry") == 0) {
+            options.compensateDry = true;
+        } else if (std::strcmp(argv[i], "--preserve-formants") == 0) {
+            options.preserveFormants = true;
+        } else if (std::strcmp(argv[i], "--track-pitch") == 0) {
+            options.trackPitch = true;
+        } else if (std::strcmp(argv[i], "--scale") == 0) {
+            if (i + 1 < argc) {
+                const char* scaleName = argv[++i];
+                if (!Scale::parse(scaleName, options.scale)) {
+                    std::cerr << "Unknown scale: " << scaleName << std::endl;
+                    std::cerr << "Scales: chromatic, <key>-major, <key>-minor (e.g. c-major, f#-minor)" << std::endl;
+                    return -1;
+                }
+                options.scaleName = scaleName;
+                options.trackPitch = true;
+                options.snapToScale = true;
+            }
+        } else if (std::strcmp(argv[i], "-c") == 0 || std::strcmp(argv[i], "--channels") == 0) {
+            if (i + 1 < argc) {
+                options.numChannels = static_cast<unsigned int>(std::max(1, std::min(32, std::atoi(argv[++i]))));
+            }
         } else if (std::strcmp(argv[i], "-f") == 0 || std::strcmp(argv[i], "--fft") == 0) {
-            enableFFT = true;
+            options.enableFFT = true;
+        } else if (std::strcmp(argv[i], "--fft-size") == 0) {
+            if (i + 1 < argc) {
+                options.fftSize = std::strtoul(argv[++i], nullptr, 10);
+                if (options.fftSize < 64 || options.fftSize > 65536 || (options.fftSize & (options.fftSize - 1)) != 0) {
+                    std::cerr << "FFT size must be a power of two between 64 and 65536" << std::endl;
+                    return -1;
+                }
+            }
+        } else if (std::strcmp(argv[i], "--fft-hop") == 0) {
+            if (i + 1 < argc) {
+                long hop = std::atol(argv[++i]);
+                if (hop < 1) {
+                    std::cerr << "FFT hop must be at least one sample" << std::endl;
+                    return -1;
+                }
+                options.fftHop = static_cast<size_t>(hop);
+            }
+        } else if (std::strcmp(argv[i], "--sliding-dft") == 0) {
+            options.meterAnalysis = MeterAnalysis::SlidingDFT;
+        } else if (std::strcmp(argv[i], "-w") == 0 || std::strcmp(argv[i], "--window") == 0) {
+            if (i + 1 < argc) {
+                const char* shapeName = argv[++i];
+                if (std::strcmp(shapeName, "hann") == 0) {
+                    options.windowShape = WindowShape::Hann;
+                } else if (std::strcmp(shapeName, "tukey") == 0) {
+                    options.windowShape = WindowShape::Tukey;
+                } else if (std::strcmp(shapeName, "blackman") == 0) {
+                    options.windowShape = WindowShape::Blackman;
+                } else {
+                    std::cerr << "Unknown window: " << shapeName << std::endl;
+                    std::cerr << "Available windows: hann, tukey, blackman" << std::endl;
+                    return -1;
+                }
+            }
+        } else if (std::strcmp(argv[i], "-i") == 0 || std::strcmp(argv[i], "--input") == 0) {
+            if (i + 1 < argc) {
+                options.inputPath = argv[++i];
+            }
+        } else if (std::strcmp(argv[i], "-o") == 0 || std::strcmp(argv[i], "--output") == 0) {
+            if (i + 1 < argc) {
+                options.outputPath = argv[++i];
+            }
+        } else if (std::strcmp(argv[i], "--pipe") == 0) {
+            if (i + 1 < argc) {
+                const char* formatName = argv[++i];
+                if (!parsePcmFormat(formatName, options.pipeFormat)) {
+                    std::cerr << "Unknown PCM format: " << formatName << std::endl;
+                    std::cerr << "Available formats: f32, s16" << std::endl;
+                    return -1;
+                }
+                options.pipe = true;
+            }
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            options.printStats = true;
+        } else if (std::strcmp(argv[i], "--stats-file") == 0) {
+            if (i + 1 < argc) {
+                options.statsPath = argv[++i];
+            }
+        } else if (std::strcmp(argv[i], "--realtime") == 0) {
+            options.realtime = true;
+        } else if (std::strcmp(argv[i], "--rt-priority") == 0) {
+            if (i + 1 < argc) {
+                int priority = std::atoi(argv[++i]);
+                if (priority < 1 || priority > 99) {
+                    std::cerr << "Real-time priority must be 1 to 99" << std::endl;
+                    return -1;
+                }
+                options.realtimePriority = priority;
+                options.realtime = true;
+            }
         } else if (std::strcmp(argv[i], "-v") == 0 || std::strcmp(argv[i], "--version") == 0) {
             std::cout << "Pocket Pitch v" << POCKET_PITCH_VERSION << std::endl;
             std::cout << "Real-time granular pitch shifter with anti-aliasing" << std::endl;
@@ -135,6 +502,30 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    if (options.lowLatency) {
+        if (options.engine != EngineType::Granular) {
+            std::cerr << "--low-latency needs the granular engine; the vocoder's latency is its frame" << std::endl;
+            return -1;
+        }
+        options.grainMs = PitchShifter::kLowLatencyGrainMs;
+    }
+    
+    // Offline rendering never touches RtAudio, so it runs on machines without devices
+    if (options.pipe) {
+        if (options.inputPath || options.outputPath) {
+            std::cerr << "--pipe reads stdin and writes stdout; drop --input and --output" << std::endl;
+            return -1;
+        }
+        return checkRealtimeGuard(renderPipe(options));
+    }
+    if (options.inputPath || options.outputPath) {
+        if (!options.inputPath || !options.outputPath) {
+            std::cerr << "Offline rendering needs both --input and --output" << std::endl;
+            return -1;
+        }
+        return checkRealtimeGuard(renderOffline(options));
+    }
+    
     RtAudio audio;
     
     if (audio.getDeviceCount() < 1) {
@@ -142,75 +533,143 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
+    unsigned int sampleRate = options.sampleRate;
+    unsigned int bufferFrames = options.bufferFrames;
+    
     RtAudio::StreamParameters inputParams, outputParams;
     inputParams.deviceId = audio.getDefaultInputDevice();
-    inputParams.nChannels = 1;
+    inputParams.nChannels = options.numChannels;
     inputParams.firstChannel = 0;
     
     outputParams.deviceId = audio.getDefaultOutputDevice();
-    outputParams.nChannels = 1;
+    outputParams.nChannels = options.numChannels;
     outputParams.firstChannel = 0;
     
-    unsigned int sampleRate = 44100;
-    unsigned int bufferFrames = 256;
-    
-    // Create pitch shifter
-    PitchShifter pitchShifter(bufferFrames, static_cast<float>(sampleRate));
-    
-    // Set pitch and mix from command line arguments
-    float pitchRatio = std::pow(2.0f, semitones / 12.0f);
-    pitchShifter.setPitchRatio(pitchRatio);
-    pitchShifter.setMixLevel(mixLevel);
+    // Create the DSP chain and spectral meter (if FFT is enabled), sharing
+    // the processor's arena, which a dry run sizes for both
+    float pitchRatio = std::pow(2.0f, options.semitones / 12.0f);
+    PitchProcessorConfig processorConfig = makeProcessorConfig(options, sampleRate, options.numChannels);
+    if (options.enableFFT) {
+        processorConfig.hostArenaBytes = measureMeter(options, sampleRate);
+    }
+    PitchProcessor processor(processorConfig);
+    PitchEngine* pitchShifter = &processor.getEngine();
+    ArenaPtr<SpectralMeter> meter;
+    if (options.enableFFT) {
+        meter = buildMeter(&processor.getArena(), options, sampleRate);
+    }
+    SpectralMeter* spectralMeter = meter.get();
+    size_t dspMemory = processor.getMemoryUsed();
     
-    // Create spectral meter if FFT is enabled
-    SpectralMeter* spectralMeter = nullptr;
-    if (enableFFT) {
-        spectralMeter = new SpectralMeter(1024);
+    // Memory locking, CPU reservation and the report; the scheduling class
+    // itself is requested through the stream options below
+    std::unique_ptr<RealtimeSetup> realtime;
+    if (options.realtime) {
+        realtime = std::make_unique<RealtimeSetup>(options.realtimePriority);
     }
     
+    CallbackStats stats;
+    StatsReporter statsReporter(stats, 1.0, options.printStats,
+                                options.statsPath ? options.statsPath : "");
+    
     AudioData data;
-    data.pitchShifter = &pitchShifter;
+    data.processor = &processor;
     data.spectralMeter = spectralMeter;
-    data.bufferSize = bufferFrames;
-    data.pitchSemitones = semitones;
-    data.outputGain = outputGain;
-    data.enableFFT = enableFFT;
-    data.usingPreset = usingPreset;
-    data.presetName = presetName;
+    data.stats = &stats;
+    data.realtime = realtime.get();
+    data.sampleRate = sampleRate;
+    data.numChannels = options.numChannels;
     
     try {
+        // Built before anything starts drawing, so Ctrl-C from here on only
+        // ends the control loop and the meter's stop() restores the cursor
+        ControlInput control(processor.getParameters(), options.semitones, options.mixLevel, options.outputGain,
+                             !options.enableFFT);
+        
+        // Low-latency mode asks the API for its smallest buffer count as well
+        RtAudio::StreamOptions streamOptions;
+        if (options.lowLatency) {
+            streamOptions.flags |= RTAUDIO_MINIMIZE_LATENCY;
+        }
+        if (realtime) {
+            streamOptions.flags |= RTAUDIO_SCHEDULE_REALTIME;
+            streamOptions.priority = realtime->getPriority();
+            realtime->beforeOpen();
+        }
         audio.openStream(&outputParams, &inputParams, RTAUDIO_FLOAT32,
-                        sampleRate, &bufferFrames, &audioCallback, &data);
+                        sampleRate, &bufferFrames, &audioCallback, &data, &streamOptions);
+        // The meter and reporter threads start after this, so they inherit
+        // the non-audio CPUs
+        if (realtime) {
+            realtime->afterOpen();
+        }
         audio.startStream();
         
-        if (!enableFFT) {
+        if (spectralMeter) {
+            spectralMeter->start();
+        }
+        if (options.printStats || options.statsPath) {
+            statsReporter.start();
+        }
+        
+        if (!options.enableFFT) {
             std::cout << "Pocket Pitch - Granular pitch shifter with anti-aliasing" << std::endl;
             std::cout << "Sample Rate: " << sampleRate << " Hz" << std::endl;
             std::cout << "Buffer Size: " << bufferFrames << " samples" << std::endl;
+            std::cout << "Channels: " << options.numChannels << std::endl;
+            std::cout << "Engine: " << getEngineName(options.engine) << std::endl;
+            std::cout << "DSP Memory: " << (dspMemory / 1024) << " KB, preallocated" << std::endl;
+            if (realtime) {
+                realtime->printReport(std::cout, kRealtimeReportWait);
+            }
+            printLatency(audio.getStreamLatency(), bufferFrames, processor.getLatencySamples(), sampleRate);
+            if (auto* granular = dynamic_cast<PitchShifter*>(pitchShifter)) {
+                std::cout << "Grain: " << options.grainMs << " ms (" << granular->getGrainSize() << " samples)" << std::endl;
+            } else if (auto* vocoder = dynamic_cast<PhaseVocoder*>(pitchShifter)) {
+                std::cout << "Frame: " << vocoder->getFrameSize() << " samples, hop " << vocoder->getHopSize() << std::endl;
+            }
             
-            if (usingPreset) {
-                std::cout << "Preset: " << presetName << " (";
-                if (semitones >= 0) {
-                    std::cout << "+" << semitones;
+            if (options.usingPreset) {
+                std::cout << "Preset: " << options.presetName << " (";
+                if (options.semitones >= 0) {
+                    std::cout << "+" << options.semitones;
                 } else {
-                    std::cout << semitones;
+                    std::cout << options.semitones;
                 }
                 std::cout << " semitones)" << std::endl;
             } else {
-                if (semitones >= 0) {
-                    std::cout << "Pitch Shift: +" << semitones << " semitones";
+                if (options.semitones >= 0) {
+                    std::cout << "Pitch Shift: +" << options.semitones << " semitones";
                 } else {
-                    std::cout << "Pitch Shift: " << semitones << " semitones";
+                    std::cout << "Pitch Shift: " << options.semitones << " semitones";
                 }
                 std::cout << " (ratio: " << pitchRatio << ")" << std::endl;
             }
-            std::cout << "Mix Level: " << (mixLevel * 100.0f) << "% wet" << std::endl;
-            std::cout << "Output Gain: " << outputGain << "x (" << (20.0f * std::log10(outputGain)) << " dB)" << std::endl;
-            std::cout << "Press Enter to quit..." << std::endl;
+            if (options.snapToScale) {
+                std::cout << "Pitch Tracking: on, snapping to " << options.scaleName << std::endl;
+            } else if (options.trackPitch) {
+                std::cout << "Pitch Tracking: on" << std::endl;
+            }
+            if (options.preserveFormants) {
+                std::cout << "Formants: preserved" << std::endl;
+            }
+            std::cout << "Mix Level: " << (options.mixLevel * 100.0f) << "% wet"
+                      << (options.compensateDry ? ", dry aligned" : "") << std::endl;
+            std::cout << "Output Gain: " << options.outputGain << "x (" << (20.0f * std::log10(options.outputGain)) << " dB)" << std::endl;
+            ControlInput::printKeyHelp();
         }
         
-        std::cin.get();
+        // Live parameter control until the user quits
+        control.run();
         
+        statsReporter.stop();
+        if (spectralMeter) {
+            spectralMeter->stop();
+            // The meter drew over the startup report
+            if (realtime) {
+                realtime->printReport(std::cout, std::chrono::milliseconds(0));
+            }
+        }
         audio.stopStream();
     } catch (RtAudioError& e) {
         e.printMessage();
@@ -221,10 +680,5 @@ int main(int argc, char* argv[]) {
         audio.closeStream();
     }
     
-    // Clean up spectral meter
-    if (spectralMeter) {
-        delete spectralMeter;
-    }
-    
-    return 0;
+    return checkRealtimeGuard(0);
 }
\ No newline at end of file